@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""Deterministic synthetic C corpus for `make bench`.
+
+Generates FILES .c files spread over a nested directory tree.  The mix is
+meant to resemble a real source tree rather than flatter out parsercfc's fast
+paths: most files define a handful of functions with real-looking bodies,
+some are header-like (prototypes only, ends up in null_fc.json), and a few
+are large generated-table files.  Seeded, so two runs produce byte-identical
+trees and numbers stay comparable across checkouts.
+"""
+
+import argparse
+import os
+import random
+
+BODY = """{
+    int acc = %d;
+    for (int i = 0; i < n; ++i) {
+        acc += tbl_%d[i %% 16] * i;   /* comment noise */
+        if (acc > 1000000)
+            acc -= "wrap"[0];
+    }
+    return acc;
+}
+"""
+
+
+def write_file(path, rng, kind):
+    parts = []
+    parts.append("/* generated by bench/gen_corpus.py -- do not edit */\n")
+    parts.append("#include <stddef.h>\n\n")
+    fid = rng.randrange(1 << 30)
+    if kind == "null":
+        for i in range(rng.randrange(2, 8)):
+            parts.append("extern int proto_%d_%d(int n, const char *s);\n" % (fid, i))
+        parts.append("typedef struct opaque_%d opaque_%d_t;\n" % (fid, fid))
+    else:
+        nfuncs = rng.randrange(2, 9) if kind == "normal" else 1
+        body_reps = 1 if kind == "normal" else 400
+        parts.append("static const int tbl_%d[16] = {%s};\n\n"
+                     % (fid, ", ".join(str(rng.randrange(100)) for _ in range(16))))
+        for i in range(nfuncs):
+            parts.append("static int fn_%d_%d(int n)\n" % (fid, i))
+            parts.append(BODY % (rng.randrange(100), fid) * body_reps)
+            parts.append("\n")
+        parts.append("int entry_%d(int n) { return fn_%d_0(n); }\n" % (fid, fid))
+    with open(path, "w") as f:
+        f.write("".join(parts))
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("out")
+    ap.add_argument("--files", type=int, default=2000)
+    ap.add_argument("--seed", type=int, default=20240817)
+    args = ap.parse_args()
+
+    rng = random.Random(args.seed)
+    for i in range(args.files):
+        d = os.path.join(args.out, "mod%02d" % (i % 37), "sub%d" % (i % 5))
+        os.makedirs(d, exist_ok=True)
+        r = rng.random()
+        kind = "null" if r < 0.15 else ("big" if r > 0.98 else "normal")
+        write_file(os.path.join(d, "unit_%05d.c" % i), rng, kind)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,89 @@
+#!/bin/sh
+# Benchmark driver for `make bench`.
+#
+# Builds the tree, generates (and caches) the synthetic corpus, runs the
+# binary across a worker sweep (1, 2, 4, ... nproc), and reports files/s and
+# MB/s per point with a comparison against bench/baseline.json.  Exits
+# non-zero when the best throughput falls below BENCH_FAIL_PCT percent of the
+# baseline, so a grammar change that slows the parser fails before nightly.
+#
+# Knobs (environment):
+#   BENCH_FILES      corpus size in .c files        (default 2000)
+#   BENCH_RUNS       timed runs per point, best-of  (default 3)
+#   BENCH_FAIL_PCT   regression threshold, percent  (default 75)
+#   BENCH_REAL_TREE  path to a pinned real-world tree (e.g. an extracted
+#                    kernel release) to sweep as a second corpus; skipped
+#                    with a note when unset -- this box has no network, so
+#                    fetching one is the caller's job.
+set -eu
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+files=${BENCH_FILES:-2000}
+runs=${BENCH_RUNS:-3}
+fail_pct=${BENCH_FAIL_PCT:-75}
+corpus="$root/bench/.corpus-$files"
+results="$root/bench/results.json"
+
+if [ ! -d "$corpus" ]; then
+    echo "bench: generating corpus ($files files)..."
+    python3 "$root/bench/gen_corpus.py" "$corpus" --files "$files"
+fi
+bytes=$(du -sb "$corpus" | cut -f1)
+
+now_ms() { date +%s%3N; }
+
+# sweep DIR LABEL -> prints per-worker lines, sets $best (files/s)
+sweep() {
+    dir=$1; label=$2; nfiles=$3; nbytes=$4
+    best=0
+    w=1
+    max=$(nproc)
+    while :; do
+        bestms=
+        i=0
+        while [ "$i" -lt "$runs" ]; do
+            t0=$(now_ms)
+            "$root/parsercfc" -w "$w" -o-fc /tmp/bench_fc.json \
+                -o-null_fc /tmp/bench_null_fc.json "$dir" >/dev/null 2>&1
+            t1=$(( $(now_ms) - t0 ))
+            [ -z "$bestms" ] || [ "$t1" -lt "$bestms" ] && bestms=$t1
+            i=$((i + 1))
+        done
+        [ "$bestms" -gt 0 ] || bestms=1
+        fps=$((nfiles * 1000 / bestms))
+        mbps=$((nbytes / bestms / 1000))
+        printf '  %-10s -w %-3s %6s ms   %7s files/s   %5s MB/s\n' \
+            "$label" "$w" "$bestms" "$fps" "$mbps"
+        [ "$fps" -gt "$best" ] && best=$fps
+        [ "$w" -ge "$max" ] && break
+        w=$((w * 2)); [ "$w" -gt "$max" ] && w=$max
+    done
+}
+
+echo "bench: building..."
+make -C "$root" -s
+echo "bench: synthetic corpus, best of $runs runs per point"
+sweep "$corpus" synthetic "$files" "$bytes"
+synth_best=$best
+
+if [ -n "${BENCH_REAL_TREE:-}" ] && [ -d "${BENCH_REAL_TREE:-}" ]; then
+    rfiles=$(find "$BENCH_REAL_TREE" -name '*.c' | wc -l)
+    rbytes=$(find "$BENCH_REAL_TREE" -name '*.c' -printf '%s\n' | awk '{s+=$1} END {print s+0}')
+    echo "bench: real tree $BENCH_REAL_TREE ($rfiles files)"
+    sweep "$BENCH_REAL_TREE" real "$rfiles" "$rbytes"
+else
+    echo "bench: BENCH_REAL_TREE not set, skipping real-world corpus"
+fi
+
+printf '{\n  "corpus_files": %s,\n  "synthetic_files_per_s": %s\n}\n' \
+    "$files" "$synth_best" > "$results"
+
+baseline=$(sed -n 's/.*"synthetic_files_per_s": *\([0-9]*\).*/\1/p' \
+    "$root/bench/baseline.json")
+floor=$((baseline * fail_pct / 100))
+echo "bench: synthetic best $synth_best files/s, baseline $baseline (floor ${fail_pct}% = $floor)"
+if [ "$synth_best" -lt "$floor" ]; then
+    echo "bench: REGRESSION: below ${fail_pct}% of baseline" >&2
+    exit 1
+fi
+echo "bench: ok"
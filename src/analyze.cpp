@@ -0,0 +1,97 @@
+#include "analyze.h"
+
+#include <sys/stat.h>
+
+#include "cache.h"
+#include "input.h"
+#include "prefilter.h"
+#include "profile.h"
+#include "parser/parse.h"
+
+std::int64_t stat_mtime_ns(const struct stat &st) {
+    return (std::int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+FileResult analyze_file(const std::string &path, ParseCache *cache) {
+    FileResult result;
+    result.path = path;
+
+    // (size, mtime) hit: the function list comes straight from the cache
+    // and the file is never opened -- on a nightly re-scan the unchanged
+    // bulk of the tree takes this path, one stat per file.
+    std::int64_t mtime_ns = -1;
+    if (cache) {
+        struct stat st;
+        PhaseScope timed(Phase::Prefilter);
+        if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            mtime_ns = stat_mtime_ns(st);
+            if (cache->lookup_stat(path, (uint64_t)st.st_size, mtime_ns,
+                                   result.functions)) {
+                result.bytes = (std::size_t)st.st_size;
+                result.cached = true;
+                return result;
+            }
+        }
+    }
+
+    InputFile file;
+    bool opened;
+    {
+        PhaseScope timed(Phase::Read);
+        opened = file.open(path);
+    }
+    if (!opened) {
+        result.io_error = true;
+        return result;
+    }
+    return analyze_buffer(path, file.data(), file.size(), cache, mtime_ns);
+}
+
+FileResult analyze_buffer(const std::string &path, const char *data,
+                          std::size_t size, ParseCache *cache,
+                          std::int64_t mtime_ns) {
+    FileResult result;
+    result.path = path;
+    result.bytes = size;
+
+    uint64_t hash = 0;
+    {
+        PhaseScope timed(Phase::Prefilter);
+        if (cache) {
+            hash = ParseCache::hash_bytes(data, size);
+            // The stat key is recorded against whatever lands below (hash
+            // hit, pre-filtered or parsed), all of which end up in the
+            // content map by the time the cache is saved.
+            if (mtime_ns >= 0)
+                cache->remember_stat(path, size, mtime_ns, hash);
+            if (cache->lookup(hash, result.functions)) {
+                result.cached = true;
+                return result;
+            }
+        }
+        if (!may_define_function(data, size)) {
+            result.prefiltered = true;
+            if (cache)
+                cache->insert(hash, result.functions);
+            return result;
+        }
+    }
+
+    // One pooled context per worker thread.  parse_source re-arms it for the
+    // next buffer with a handful of pointer writes: the arena keeps its
+    // chunks, the typedef set its buckets, the result vector its capacity --
+    // no per-file allocation once a worker is warmed up.
+    thread_local ParseContext ctx;
+    ctx.path = path.c_str();
+    int64_t t0 = profiler().enabled() ? profile_now_ns() : 0;
+    parse_source(ctx, data, size);
+    if (t0) {
+        uint64_t ns = (uint64_t)(profile_now_ns() - t0);
+        profiler().add(Phase::Parse, ns);
+        profiler().record_file(result.path, ns);
+    }
+    result.functions = std::move(ctx.functions);
+    if (cache)
+        cache->insert(hash, result.functions);
+    return result;
+}
@@ -0,0 +1,47 @@
+#ifndef PARSERCFC_ANALYZE_H
+#define PARSERCFC_ANALYZE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ParseCache;
+struct stat;
+
+// Result of analyzing one .c file.  `functions` holds the names of every
+// function *defined* (not merely declared) in the file, in source order.
+// The names are interned in the process-wide StringPool (distinct spellings
+// are finite); the path is owned, so nothing per-file outlives the result --
+// that is what keeps --stream runs flat over arbitrarily large trees.
+struct FileResult {
+    std::string path;
+    std::vector<const char *> functions;
+    // Size of the file's content in bytes (0 when it was unreadable).
+    std::size_t bytes = 0;
+    bool io_error = false;
+    // True when the pre-filter proved the file defines nothing and the
+    // parser was never run.
+    bool prefiltered = false;
+    // True when the result came out of the parse cache.
+    bool cached = false;
+};
+
+// Analyzes a single .c file and extracts its defined function names.
+// `cache` may be null; when set, a file whose (size, mtime) match a cached
+// entry is answered without being opened at all, and unchanged content
+// under a new mtime is answered after hashing but without a parse.
+FileResult analyze_file(const std::string &path, ParseCache *cache);
+
+// Same pipeline (cache lookup, pre-filter, parse) over bytes the caller has
+// already read -- the io_uring read path lands here.  A non-negative
+// `mtime_ns` records the file's stat key in the cache, so the next run can
+// skip the read entirely.
+FileResult analyze_buffer(const std::string &path, const char *data,
+                          std::size_t size, ParseCache *cache,
+                          std::int64_t mtime_ns = -1);
+
+// The file's modification time folded to one number, as the cache keys it.
+std::int64_t stat_mtime_ns(const struct stat &st);
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef PARSERCFC_ARENA_H
+#define PARSERCFC_ARENA_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "govern.h"
+#include "hugepage.h"
+
+// Bump allocator for parse-lifetime data.  Token spellings and typedef names
+// are tiny, numerous and all die together when the file is done, which is the
+// worst possible load for malloc and the best possible one for an arena:
+// allocation is a pointer bump, and reset() rewinds without returning chunks
+// to the OS so the next parse starts hot.
+//
+// The first chunk is a small malloc -- most parse contexts never outgrow
+// it and faulting a fresh 2M mapping per worker would cost more than it
+// returns.  Growth chunks are one 2M huge page each (hugepage.h): an arena
+// that keeps growing (the intern pool, a worker chewing generated files) is
+// exactly the memory every worker walks continuously, where a single TLB
+// entry per chunk beats 512 4K ones.  When huge_alloc's mmap fails the
+// chunk falls back to malloc.
+class Arena {
+public:
+    static constexpr std::size_t kChunkSize = 64 * 1024;
+
+    Arena() = default;
+    ~Arena() {
+        for (Chunk &c : chunks_) {
+            governor().sub(MemGovernor::Arena, c.size);
+            if (c.huge)
+                huge_free(c.base, c.size);
+            else
+                std::free(c.base);
+        }
+    }
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    char *alloc(std::size_t n) {
+        n = (n + 7) & ~std::size_t(7);
+        if (current_ >= chunks_.size() || chunks_[current_].used + n > chunks_[current_].size)
+            if (!next_chunk(n))
+                throw std::bad_alloc();
+        Chunk &c = chunks_[current_];
+        char *p = c.base + c.used;
+        c.used += n;
+        return p;
+    }
+
+    // Copies [s, s+n) and nul-terminates; the result lives until reset().
+    const char *copy(const char *s, std::size_t n) {
+        char *p = alloc(n + 1);
+        std::memcpy(p, s, n);
+        p[n] = '\0';
+        return p;
+    }
+
+    // Rewinds to empty, keeping every chunk for reuse.
+    void reset() {
+        for (Chunk &c : chunks_)
+            c.used = 0;
+        current_ = 0;
+    }
+
+    // Bytes currently handed out (for budget accounting).
+    std::size_t used() const {
+        std::size_t total = 0;
+        for (const Chunk &c : chunks_)
+            total += c.used;
+        return total;
+    }
+
+private:
+    struct Chunk {
+        char *base;
+        std::size_t size;
+        std::size_t used;
+        bool huge;
+    };
+
+    bool next_chunk(std::size_t need) {
+        // Reuse an already-allocated later chunk when it fits.
+        while (current_ + 1 < chunks_.size()) {
+            ++current_;
+            if (chunks_[current_].used + need <= chunks_[current_].size)
+                return true;
+        }
+        std::size_t size = need > kChunkSize ? need : kChunkSize;
+        char *base = nullptr;
+        bool huge = false;
+        if (!chunks_.empty() || need > kChunkSize) {
+            std::size_t huge_size = size < kHugePageSize ? kHugePageSize : size;
+            base = (char *)huge_alloc(huge_size);
+            if (base) {
+                size = huge_size;
+                huge = true;
+            }
+        }
+        if (!base)
+            base = (char *)std::malloc(size);
+        if (!base)
+            return false;
+        // Chunk-granular budget accounting: one bump per chunk of growth,
+        // not per allocation.
+        governor().add(MemGovernor::Arena, size);
+        chunks_.push_back(Chunk{base, size, 0, huge});
+        current_ = chunks_.size() - 1;
+        return true;
+    }
+
+    std::vector<Chunk> chunks_;
+    std::size_t current_ = 0;
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include "binout.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+#include "input.h"
+#include "output.h"
+
+namespace {
+
+// Offsets are assigned per distinct pointer: the StringPool already
+// guarantees one pointer per distinct spelling, so the key can be the
+// pointer itself.
+class StrtabBuilder {
+public:
+    uint64_t add(const char *s) {
+        auto it = offsets_.find(s);
+        if (it != offsets_.end())
+            return it->second;
+        uint64_t off = append(s);
+        offsets_.emplace(s, off);
+        return off;
+    }
+
+    // Paths are unique per entry, so they skip the dedup map.
+    uint64_t append(std::string_view s) {
+        uint64_t off = bytes_.size();
+        bytes_.append(s);
+        bytes_.push_back('\0');
+        return off;
+    }
+
+    const std::string &bytes() const { return bytes_; }
+
+private:
+    std::unordered_map<const void *, uint64_t> offsets_;
+    std::string bytes_;
+};
+
+} // namespace
+
+bool write_fc_bin(const std::string &path, const std::vector<FileResult> &results) {
+    StrtabBuilder strtab;
+    std::vector<FcBinEntry> entries;
+    std::vector<uint64_t> func_offs;
+    entries.reserve(results.size());
+
+    const uint64_t entries_off = sizeof(FcBinHeader);
+    const uint64_t funcs_off = entries_off + results.size() * sizeof(FcBinEntry);
+
+    for (const FileResult &r : results) {
+        FcBinEntry e;
+        e.path_off = strtab.append(r.path);
+        e.funcs_off = funcs_off + func_offs.size() * sizeof(uint64_t);
+        e.func_count = (uint32_t)r.functions.size();
+        e.flags = r.io_error ? 1u : 0u;
+        for (const char *name : r.functions)
+            func_offs.push_back(strtab.add(name));
+        entries.push_back(e);
+    }
+
+    FcBinHeader header;
+    std::memcpy(header.magic, "PCFC", 4);
+    header.version = 1;
+    header.file_count = results.size();
+    header.entries_off = entries_off;
+    header.funcs_off = funcs_off;
+    header.strtab_off = funcs_off + func_offs.size() * sizeof(uint64_t);
+    header.strtab_size = strtab.bytes().size();
+
+    std::string tmp = path + ".tmp";
+    std::FILE *f = std::fopen(tmp.c_str(), "wb");
+    if (!f) {
+        std::fprintf(stderr, "parsercfc: cannot write %s\n", path.c_str());
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    if (!entries.empty())
+        ok = std::fwrite(entries.data(), sizeof(FcBinEntry), entries.size(), f)
+                 == entries.size() && ok;
+    if (!func_offs.empty())
+        ok = std::fwrite(func_offs.data(), sizeof(uint64_t), func_offs.size(), f)
+                 == func_offs.size() && ok;
+    ok = std::fwrite(strtab.bytes().data(), 1, strtab.bytes().size(), f)
+             == strtab.bytes().size() && ok;
+    ok = std::fclose(f) == 0 && ok;
+    if (ok)
+        ok = std::rename(tmp.c_str(), path.c_str()) == 0;
+    return ok;
+}
+
+namespace {
+
+[[noreturn]] void convert_error(const std::string &path, const char *what) {
+    std::fprintf(stderr, "parsercfc: %s: %s\n", path.c_str(), what);
+    std::exit(1);
+}
+
+} // namespace
+
+int run_convert(const Options &opt) {
+    InputFile file;
+    if (!file.open(opt.convert_path)) {
+        std::fprintf(stderr, "parsercfc: cannot read %s\n",
+                     opt.convert_path.c_str());
+        return 1;
+    }
+    const char *data = file.data();
+    std::size_t size = file.size();
+    if (size < sizeof(FcBinHeader))
+        convert_error(opt.convert_path, "not an fc.bin file (too short)");
+    FcBinHeader h;
+    std::memcpy(&h, data, sizeof(h));
+    if (std::memcmp(h.magic, "PCFC", 4) != 0 || h.version != 1)
+        convert_error(opt.convert_path, "not a version-1 fc.bin file");
+    if (h.entries_off + h.file_count * sizeof(FcBinEntry) > size ||
+        h.strtab_off + h.strtab_size > size ||
+        (h.strtab_size && data[h.strtab_off + h.strtab_size - 1] != '\0'))
+        convert_error(opt.convert_path, "fc.bin is truncated or corrupt");
+    const char *strtab = data + h.strtab_off;
+
+    std::string fc_tmp = opt.output_fc + ".tmp";
+    std::string null_tmp = opt.output_null_fc + ".tmp";
+    std::FILE *fc = std::fopen(fc_tmp.c_str(), "wb");
+    std::FILE *null_fc = std::fopen(null_tmp.c_str(), "wb");
+    if (!fc || !null_fc) {
+        std::fprintf(stderr, "parsercfc: cannot write outputs\n");
+        return 1;
+    }
+    std::fputs("{", fc);
+    std::fputs("[", null_fc);
+    bool fc_first = true, null_first = true;
+    for (uint64_t i = 0; i < h.file_count; ++i) {
+        FcBinEntry e;
+        std::memcpy(&e, data + h.entries_off + i * sizeof(e), sizeof(e));
+        if (e.path_off >= h.strtab_size ||
+            e.funcs_off + e.func_count * sizeof(uint64_t) > size)
+            convert_error(opt.convert_path, "fc.bin entry out of bounds");
+
+        std::string entry;
+        append_json_string(entry, strtab + e.path_off);
+        entry += ": {\"fc\": [";
+        for (uint32_t f = 0; f < e.func_count; ++f) {
+            uint64_t name_off;
+            std::memcpy(&name_off, data + e.funcs_off + f * sizeof(name_off),
+                        sizeof(name_off));
+            if (name_off >= h.strtab_size)
+                convert_error(opt.convert_path, "fc.bin name out of bounds");
+            if (f)
+                entry += ", ";
+            append_json_string(entry, strtab + name_off);
+        }
+        entry += "]}";
+        std::fputs(fc_first ? "\n    " : ",\n    ", fc);
+        fc_first = false;
+        std::fwrite(entry.data(), 1, entry.size(), fc);
+
+        if (e.func_count == 0) {
+            std::string line;
+            append_json_string(line, strtab + e.path_off);
+            std::fputs(null_first ? "\n    " : ",\n    ", null_fc);
+            null_first = false;
+            std::fwrite(line.data(), 1, line.size(), null_fc);
+        }
+    }
+    std::fputs("\n}\n", fc);
+    std::fputs("\n]\n", null_fc);
+    bool ok = std::fclose(fc) == 0;
+    ok = std::fclose(null_fc) == 0 && ok;
+    ok = ok && std::rename(fc_tmp.c_str(), opt.output_fc.c_str()) == 0 &&
+         std::rename(null_tmp.c_str(), opt.output_null_fc.c_str()) == 0;
+    if (!ok)
+        std::fprintf(stderr, "parsercfc: cannot write outputs\n");
+    return ok ? 0 : 1;
+}
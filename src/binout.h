@@ -0,0 +1,45 @@
+#ifndef PARSERCFC_BINOUT_H
+#define PARSERCFC_BINOUT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "analyze.h"
+#include "options.h"
+
+// Binary result format (-o-bin), designed to be mmap'd and indexed in place
+// by downstream tooling instead of re-parsing gigabytes of JSON.  All offsets
+// are u64 from the start of the file; all integers little-endian.
+//
+//   [0]  FcBinHeader
+//   [1]  FcBinEntry[file_count]      one per .c file, in output order
+//   [2]  u64[...]                    per-entry arrays of name offsets;
+//                                    entry.funcs_off points at its slice
+//   [3]  string table                nul-terminated; each distinct function
+//                                    name appears once, paths once per entry
+struct FcBinHeader {
+    char magic[4];          // "PCFC"
+    uint32_t version;       // 1
+    uint64_t file_count;
+    uint64_t entries_off;
+    uint64_t funcs_off;     // start of section [2]
+    uint64_t strtab_off;
+    uint64_t strtab_size;
+};
+
+struct FcBinEntry {
+    uint64_t path_off;      // into string table
+    uint64_t funcs_off;     // into section [2], byte offset from file start
+    uint32_t func_count;
+    uint32_t flags;         // bit 0: unreadable (io_error)
+};
+
+bool write_fc_bin(const std::string &path, const std::vector<FileResult> &results);
+
+// --convert: rewrites an existing fc.bin as fc.json / null_fc.json (the
+// -o-fc / -o-null_fc paths) without re-scanning anything.  The reverse
+// direction is just a scan with -o-bin, so there is no json-to-bin mode.
+int run_convert(const Options &opt);
+
+#endif
@@ -0,0 +1,168 @@
+#include "cache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include "strpool.h"
+
+uint64_t ParseCache::hash_bytes(const char *data, std::size_t size) {
+    // FNV-1a, 64-bit.  Fast enough to be invisible next to the parse and
+    // collision-safe enough for a cache that only ever trades work for work.
+    uint64_t h = 1469598103934665603ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void ParseCache::load(const std::string &path) {
+    std::ifstream in(path);
+    if (!in)
+        return;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[0] == '@') {
+            // Stat entry: @<hash>\t<size>\t<mtime-ns>\t<path>.  The path is
+            // last so it may contain anything but a tab-free prefix cannot
+            // be mistaken for the numeric fields.
+            std::size_t t1 = line.find('\t');
+            std::size_t t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+            std::size_t t3 = t2 == std::string::npos ? t2 : line.find('\t', t2 + 1);
+            if (t3 == std::string::npos || t3 + 1 >= line.size())
+                continue;
+            char *end = nullptr;
+            StatKey key;
+            std::string field = line.substr(1, t1 - 1);
+            key.hash = std::strtoull(field.c_str(), &end, 16);
+            if (field.empty() || *end != '\0')
+                continue;
+            field = line.substr(t1 + 1, t2 - t1 - 1);
+            key.size = std::strtoull(field.c_str(), &end, 10);
+            if (field.empty() || *end != '\0')
+                continue;
+            field = line.substr(t2 + 1, t3 - t2 - 1);
+            key.mtime_ns = std::strtoll(field.c_str(), &end, 10);
+            if (field.empty() || *end != '\0')
+                continue;
+            stat_preloaded_.emplace(line.substr(t3 + 1), key);
+            continue;
+        }
+        std::size_t tab = line.find('\t');
+        std::string key = line.substr(0, tab == std::string::npos ? line.size() : tab);
+        char *end = nullptr;
+        uint64_t hash = std::strtoull(key.c_str(), &end, 16);
+        if (key.empty() || *end != '\0')
+            continue;
+        std::vector<const char *> functions;
+        while (tab != std::string::npos) {
+            std::size_t next = line.find('\t', tab + 1);
+            std::string name = line.substr(tab + 1,
+                next == std::string::npos ? std::string::npos : next - tab - 1);
+            if (!name.empty())
+                functions.push_back(string_pool().intern(name));
+            tab = next;
+        }
+        preloaded_.emplace(hash, std::move(functions));
+    }
+}
+
+bool ParseCache::lookup(uint64_t hash, std::vector<const char *> &functions) const {
+    auto it = preloaded_.find(hash);
+    if (it != preloaded_.end()) {
+        functions = it->second;
+        std::lock_guard<std::mutex> lock(fresh_mutex_);
+        used_.insert(hash);
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(fresh_mutex_);
+    it = fresh_.find(hash);
+    if (it == fresh_.end())
+        return false;
+    functions = it->second;
+    return true;
+}
+
+void ParseCache::insert(uint64_t hash, const std::vector<const char *> &functions) {
+    std::lock_guard<std::mutex> lock(fresh_mutex_);
+    fresh_.emplace(hash, functions);
+}
+
+bool ParseCache::lookup_stat(const std::string &path, uint64_t size,
+                             int64_t mtime_ns,
+                             std::vector<const char *> &functions) const {
+    StatKey key;
+    bool fresh = false;
+    {
+        std::lock_guard<std::mutex> lock(fresh_mutex_);
+        auto it = stat_fresh_.find(path);
+        if (it != stat_fresh_.end()) {
+            key = it->second;
+            fresh = true;
+        }
+    }
+    if (!fresh) {
+        auto it = stat_preloaded_.find(path);
+        if (it == stat_preloaded_.end())
+            return false;
+        key = it->second;
+    }
+    if (key.size != size || key.mtime_ns != mtime_ns)
+        return false;
+    // The stat entry only points at a content entry; a dangling pointer
+    // (hash entry evicted) falls through to the hashing path and heals.
+    if (!lookup(key.hash, functions))
+        return false;
+    if (!fresh) {
+        std::lock_guard<std::mutex> lock(fresh_mutex_);
+        stat_used_.insert(path);
+    }
+    return true;
+}
+
+void ParseCache::remember_stat(const std::string &path, uint64_t size,
+                               int64_t mtime_ns, uint64_t hash) {
+    std::lock_guard<std::mutex> lock(fresh_mutex_);
+    StatKey &key = stat_fresh_[path];
+    key.size = size;
+    key.mtime_ns = mtime_ns;
+    key.hash = hash;
+}
+
+bool ParseCache::save(const std::string &path) const {
+    std::string tmp = path + ".tmp";
+    std::FILE *f = std::fopen(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+    // Preloaded entries never touched this run belong to files that are gone
+    // or rewritten; dropping them here is the cache's only form of eviction.
+    for (const auto *map : {&preloaded_, &fresh_}) {
+        for (const auto &entry : *map) {
+            if (map == &preloaded_ && !used_.count(entry.first))
+                continue;
+            if (map == &fresh_ && preloaded_.count(entry.first) &&
+                used_.count(entry.first))
+                continue;
+            std::fprintf(f, "%016llx", (unsigned long long)entry.first);
+            for (const char *name : entry.second)
+                std::fprintf(f, "\t%s", name);
+            std::fputc('\n', f);
+        }
+    }
+    for (const auto *map : {&stat_preloaded_, &stat_fresh_}) {
+        for (const auto &entry : *map) {
+            if (map == &stat_preloaded_ &&
+                (!stat_used_.count(entry.first) || stat_fresh_.count(entry.first)))
+                continue;
+            std::fprintf(f, "@%016llx\t%llu\t%lld\t%s\n",
+                         (unsigned long long)entry.second.hash,
+                         (unsigned long long)entry.second.size,
+                         (long long)entry.second.mtime_ns,
+                         entry.first.c_str());
+        }
+    }
+    if (std::fclose(f) != 0)
+        return false;
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
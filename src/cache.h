@@ -0,0 +1,73 @@
+#ifndef PARSERCFC_CACHE_H
+#define PARSERCFC_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Parse cache with two levels of key.  The first is the path plus the
+// file's (size, mtime): a hit answers from the cache without opening the
+// file at all, which is what makes a nightly re-scan of a mostly-unchanged
+// tree cheap -- the unchanged 99% costs one stat each.  The second is the
+// file *content* hash, so a file whose mtime moved but whose bytes did not
+// (touch, checkout) still skips the parse, and identical files (common
+// with vendored copies) are parsed once ever.  The on-disk form is one
+// line per entry:
+//   <16-hex-digit hash>\t<name>\t<name>...            content entry
+//   @<16-hex-digit hash>\t<size>\t<mtime-ns>\t<path>  stat entry
+// save() keeps only entries touched since load, so deleted and rewritten
+// files age out instead of accumulating forever.
+// Entries preloaded before the pool starts live in immutable maps that
+// lookups read without locking (a hit takes the mutex once, to mark the
+// entry as still live); entries added during the run sit in second maps
+// behind that mutex, which is cheap because a miss is dominated by the
+// parse it just paid for.
+class ParseCache {
+public:
+    // Loads `path` if it exists.  A missing file is an empty cache, not an
+    // error; a malformed line invalidates only itself.
+    void load(const std::string &path);
+
+    // Returns true and fills `functions` when `hash` is known.
+    bool lookup(uint64_t hash, std::vector<const char *> &functions) const;
+
+    void insert(uint64_t hash, const std::vector<const char *> &functions);
+
+    // Returns true and fills `functions` when `path` was cached with this
+    // exact (size, mtime) -- the caller never has to open the file.
+    bool lookup_stat(const std::string &path, uint64_t size, int64_t mtime_ns,
+                     std::vector<const char *> &functions) const;
+
+    // Records that `path` currently has this (size, mtime) and hashes to
+    // `hash`, so the next run can take the stat fast path.
+    void remember_stat(const std::string &path, uint64_t size, int64_t mtime_ns,
+                       uint64_t hash);
+
+    // Writes every entry touched since load back to `path`; the rest --
+    // files deleted or rewritten since the cache was built -- are dropped.
+    bool save(const std::string &path) const;
+
+    static uint64_t hash_bytes(const char *data, std::size_t size);
+
+private:
+    struct StatKey {
+        uint64_t size = 0;
+        int64_t mtime_ns = 0;
+        uint64_t hash = 0;
+    };
+
+    std::unordered_map<uint64_t, std::vector<const char *>> preloaded_;
+    std::unordered_map<uint64_t, std::vector<const char *>> fresh_;
+    std::unordered_map<std::string, StatKey> stat_preloaded_;
+    std::unordered_map<std::string, StatKey> stat_fresh_;
+    // Preloaded entries hit this run; fresh entries are live by definition.
+    mutable std::unordered_set<uint64_t> used_;
+    mutable std::unordered_set<std::string> stat_used_;
+    mutable std::mutex fresh_mutex_;
+};
+
+#endif
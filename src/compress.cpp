@@ -0,0 +1,115 @@
+#include "compress.h"
+
+#include <dlfcn.h>
+
+namespace {
+
+// Mirrors of the public zstd API types and constants we use.  These are
+// stable ABI (zstd >= 1.4): the struct layouts and the enum values below are
+// documented as frozen, which is what makes declaring them here safe.
+struct ZSTD_inBuffer { const void *src; size_t size; size_t pos; };
+struct ZSTD_outBuffer { void *dst; size_t size; size_t pos; };
+constexpr int kZSTD_c_compressionLevel = 100;
+constexpr int kZSTD_e_continue = 0;
+constexpr int kZSTD_e_end = 2;
+
+struct ZstdLib {
+    void *(*createCCtx)() = nullptr;
+    size_t (*freeCCtx)(void *) = nullptr;
+    size_t (*setParameter)(void *, int, int) = nullptr;
+    size_t (*compressStream2)(void *, ZSTD_outBuffer *, ZSTD_inBuffer *, int) = nullptr;
+    unsigned (*isError)(size_t) = nullptr;
+    bool ok = false;
+
+    ZstdLib() {
+        void *h = dlopen("libzstd.so.1", RTLD_NOW);
+        if (!h)
+            return;
+        createCCtx = (void *(*)())dlsym(h, "ZSTD_createCCtx");
+        freeCCtx = (size_t (*)(void *))dlsym(h, "ZSTD_freeCCtx");
+        setParameter = (size_t (*)(void *, int, int))dlsym(h, "ZSTD_CCtx_setParameter");
+        compressStream2 = (size_t (*)(void *, ZSTD_outBuffer *, ZSTD_inBuffer *, int))
+            dlsym(h, "ZSTD_compressStream2");
+        isError = (unsigned (*)(size_t))dlsym(h, "ZSTD_isError");
+        ok = createCCtx && freeCCtx && setParameter && compressStream2 && isError;
+    }
+};
+
+const ZstdLib &lib() {
+    static const ZstdLib instance;
+    return instance;
+}
+
+} // namespace
+
+bool zstd_available() {
+    return lib().ok;
+}
+
+ZstdStream::~ZstdStream() {
+    if (cctx_)
+        lib().freeCCtx(cctx_);
+}
+
+bool ZstdStream::open(std::FILE *out, int level) {
+    if (!lib().ok)
+        return false;
+    cctx_ = lib().createCCtx();
+    if (!cctx_)
+        return false;
+    lib().setParameter(cctx_, kZSTD_c_compressionLevel, level);
+    out_ = out;
+    buf_.resize(1 << 16);
+    return true;
+}
+
+bool ZstdStream::pump(const char *data, std::size_t n, int end_op) {
+    ZSTD_inBuffer in{data, n, 0};
+    for (;;) {
+        ZSTD_outBuffer out{buf_.data(), buf_.size(), 0};
+        size_t rc = lib().compressStream2(cctx_, &out, &in, end_op);
+        if (lib().isError(rc))
+            return false;
+        if (out.pos &&
+            std::fwrite(buf_.data(), 1, out.pos, out_) != out.pos)
+            return false;
+        bool done = end_op == kZSTD_e_end ? rc == 0 : in.pos == in.size;
+        if (done)
+            return true;
+    }
+}
+
+bool ZstdStream::write(const char *data, std::size_t n) {
+    wrote_ = true;
+    return pump(data, n, kZSTD_e_continue);
+}
+
+bool ZstdStream::finish() {
+    if (!cctx_)
+        return true;
+    bool ok = !wrote_ || pump(nullptr, 0, kZSTD_e_end);
+    lib().freeCCtx(cctx_);
+    cctx_ = nullptr;
+    out_ = nullptr;
+    return ok;
+}
+
+bool zstd_compress_frame(std::string_view in, std::string &out, int level) {
+    if (!lib().ok)
+        return false;
+    void *cctx = lib().createCCtx();
+    if (!cctx)
+        return false;
+    lib().setParameter(cctx, kZSTD_c_compressionLevel, level);
+    // Worst case for tiny inputs is input + frame overhead; 512 covers the
+    // few-byte snippets this is used for with room to spare.
+    std::vector<char> buf(in.size() + 512);
+    ZSTD_inBuffer src{in.data(), in.size(), 0};
+    ZSTD_outBuffer dst{buf.data(), buf.size(), 0};
+    size_t rc = lib().compressStream2(cctx, &dst, &src, kZSTD_e_end);
+    lib().freeCCtx(cctx);
+    if (lib().isError(rc) || rc != 0)
+        return false;
+    out.append(buf.data(), dst.pos);
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef PARSERCFC_COMPRESS_H
+#define PARSERCFC_COMPRESS_H
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Zstandard output support (--compress zstd[:level]).  The build hosts ship
+// libzstd.so.1 but not the development headers, so the library is loaded
+// with dlopen and the handful of stable-ABI entry points are declared
+// locally; zstd_available() tells the caller whether that worked.
+bool zstd_available();
+
+// Streaming compressor over a FILE* the caller owns.  One instance produces
+// one zstd frame: open() starts it, write() feeds it, finish() ends it.
+// Frames concatenate into a valid .zst stream, which is what lets each
+// worker compress its own shard in parallel and the merge step glue them
+// together without recompressing anything.
+class ZstdStream {
+public:
+    ~ZstdStream();
+
+    bool open(std::FILE *out, int level);
+    bool write(const char *data, std::size_t n);
+    // Ends the frame and flushes; a stream that never saw a write() emits
+    // nothing at all, so empty shards stay zero bytes.
+    bool finish();
+
+private:
+    bool pump(const char *data, std::size_t n, int end_op);
+
+    void *cctx_ = nullptr;
+    std::FILE *out_ = nullptr;
+    std::vector<char> buf_;
+    bool wrote_ = false;
+};
+
+// One-shot: compresses `in` into a single frame appended to `out`.  Used for
+// the head/separator/tail snippets around the spliced shard frames.
+bool zstd_compress_frame(std::string_view in, std::string &out, int level);
+
+#endif
@@ -0,0 +1,163 @@
+#include "daemon.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#include "cache.h"
+#include "run.h"
+
+namespace {
+
+bool fill_sockaddr(const std::string &path, sockaddr_un &addr) {
+    if (path.size() >= sizeof(addr.sun_path))
+        return false;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+    return true;
+}
+
+// Reads one \n-terminated line (without the newline).
+bool read_line(int fd, std::string &line) {
+    line.clear();
+    char c;
+    for (;;) {
+        ssize_t n = read(fd, &c, 1);
+        if (n <= 0)
+            return !line.empty();
+        if (c == '\n')
+            return true;
+        line += c;
+        if (line.size() > 65536)
+            return false;
+    }
+}
+
+// Best-effort: a peer that hung up (EPIPE/ECONNRESET) just stops the write.
+// The daemon must survive that -- a client killed mid-reply is routine in CI
+// -- so SIGPIPE is ignored for the daemon process (see run_daemon).
+void write_all(int fd, const std::string &s) {
+    size_t off = 0;
+    while (off < s.size()) {
+        ssize_t n = write(fd, s.data() + off, s.size() - off);
+        if (n <= 0)
+            return;
+        off += (size_t)n;
+    }
+}
+
+std::vector<std::string> split_tabs(const std::string &line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string::npos
+                                                ? std::string::npos : tab - start));
+        if (tab == std::string::npos)
+            return fields;
+        start = tab + 1;
+    }
+}
+
+} // namespace
+
+int run_daemon(const Options &opt) {
+    // A client that disconnects before reading its reply must not take the
+    // daemon down with it: without this, the reply write raises SIGPIPE and
+    // kills the warm process every flaky client was the reason to have.
+    signal(SIGPIPE, SIG_IGN);
+    sockaddr_un addr;
+    if (!fill_sockaddr(opt.socket_path, addr)) {
+        std::fprintf(stderr, "parsercfc: socket path too long: %s\n",
+                     opt.socket_path.c_str());
+        return 1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::perror("parsercfc: socket");
+        return 1;
+    }
+    unlink(opt.socket_path.c_str()); // stale socket from a previous daemon
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        std::perror("parsercfc: bind/listen");
+        close(fd);
+        return 1;
+    }
+
+    // The warm state: one cache shared by every request.  Arena chunks and
+    // pooled parser state warm up inside the workers as requests arrive.
+    ParseCache cache;
+    if (!opt.cache_path.empty())
+        cache.load(opt.cache_path);
+
+    std::fprintf(stderr, "parsercfc: daemon listening on %s\n", opt.socket_path.c_str());
+    for (;;) {
+        int conn = accept(fd, nullptr, nullptr);
+        if (conn < 0)
+            continue;
+        std::string line;
+        if (!read_line(conn, line)) {
+            close(conn);
+            continue;
+        }
+        std::vector<std::string> fields = split_tabs(line);
+        if (fields.size() != 4 || fields[0] != "parse" || fields[1].empty()) {
+            write_all(conn, "err\tmalformed request\n");
+            close(conn);
+            continue;
+        }
+        Options req = opt;
+        req.dir = fields[1];
+        if (!fields[2].empty())
+            req.output_fc = fields[2];
+        if (!fields[3].empty())
+            req.output_null_fc = fields[3];
+
+        RunResult r = run_scan(req, &cache, /*show_progress=*/false);
+        write_all(conn, std::string(r.ok ? "ok\t" : "err\t") + r.summary + "\n");
+        close(conn);
+
+        if (!opt.cache_path.empty() && !cache.save(opt.cache_path))
+            std::fprintf(stderr, "parsercfc: warning: could not update cache %s\n",
+                         opt.cache_path.c_str());
+    }
+}
+
+int submit_to_daemon(const Options &opt) {
+    sockaddr_un addr;
+    if (!fill_sockaddr(opt.socket_path, addr)) {
+        std::fprintf(stderr, "parsercfc: socket path too long: %s\n",
+                     opt.socket_path.c_str());
+        return 1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::perror("parsercfc: socket");
+        return 1;
+    }
+    if (connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+        std::fprintf(stderr, "parsercfc: no daemon at %s\n", opt.socket_path.c_str());
+        close(fd);
+        return 1;
+    }
+    write_all(fd, "parse\t" + opt.dir + "\t" + opt.output_fc + "\t" +
+                      opt.output_null_fc + "\n");
+    std::string reply;
+    read_line(fd, reply);
+    close(fd);
+
+    std::vector<std::string> fields = split_tabs(reply);
+    if (fields.size() == 2 && fields[0] == "ok") {
+        std::fprintf(stderr, "%s\n", fields[1].c_str());
+        return 0;
+    }
+    std::fprintf(stderr, "parsercfc: daemon error: %s\n",
+                 fields.size() == 2 ? fields[1].c_str() : "no reply");
+    return 1;
+}
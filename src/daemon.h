@@ -0,0 +1,28 @@
+#ifndef PARSERCFC_DAEMON_H
+#define PARSERCFC_DAEMON_H
+
+#include "options.h"
+
+// Daemon mode: keep one warm parsercfc process behind a Unix-domain socket
+// so repeat scans skip process start, cache load and (with --cache) most of
+// the parsing.  The protocol is one tab-separated request line per
+// connection:
+//
+//     parse\t<dir>\t<fc_out>\t<null_fc_out>\n
+//
+// answered with
+//
+//     ok\t<summary>\n    or    err\t<message>\n
+//
+// Requests are served one at a time; each request already uses the full
+// worker pool, so queueing clients is the right behavior.
+
+// Serves requests forever (until the process is killed).  Returns nonzero
+// only if the socket could not be set up.
+int run_daemon(const Options &opt);
+
+// Client side: submits opt.dir / output paths to a running daemon at
+// opt.socket_path, prints the daemon's summary, returns its status.
+int submit_to_daemon(const Options &opt);
+
+#endif
@@ -0,0 +1,46 @@
+#include "filter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fnmatch.h>
+
+bool PathFilter::Pattern::matches(const char *rel) const {
+    if (is_regex)
+        return std::regex_search(rel, re);
+    return fnmatch(glob.c_str(), rel, 0) == 0;
+}
+
+PathFilter::Pattern PathFilter::make(std::string pattern) {
+    Pattern p;
+    if (pattern.compare(0, 3, "re:") == 0) {
+        p.is_regex = true;
+        try {
+            p.re = std::regex(pattern.substr(3));
+        } catch (const std::regex_error &) {
+            std::fprintf(stderr, "parsercfc: error: bad regex in %s\n", pattern.c_str());
+            std::exit(2);
+        }
+    } else {
+        p.glob = std::move(pattern);
+    }
+    return p;
+}
+
+bool PathFilter::allows(const char *rel) const {
+    for (const Pattern &p : excludes_)
+        if (p.matches(rel))
+            return false;
+    if (includes_.empty())
+        return true;
+    for (const Pattern &p : includes_)
+        if (p.matches(rel))
+            return true;
+    return false;
+}
+
+bool PathFilter::descend(const char *rel) const {
+    for (const Pattern &p : excludes_)
+        if (p.matches(rel))
+            return false;
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef PARSERCFC_FILTER_H
+#define PARSERCFC_FILTER_H
+
+#include <regex>
+#include <string>
+#include <vector>
+
+// Path filtering pushed down into enumeration (--include / --exclude).
+// Patterns match the path *relative to the scanned dir*.  By default a
+// pattern is a glob in fnmatch terms where `*` crosses directory separators
+// (so `drivers/*` takes the whole subtree); a pattern starting with `re:`
+// is an ECMAScript regex matched anywhere in the relative path.  Excluded
+// directories are pruned before being descended into, which is the whole
+// point: a run filtered to 2% of the tree does 2% of the traversal.
+class PathFilter {
+public:
+    void add_include(std::string pattern) { includes_.push_back(make(std::move(pattern))); }
+    void add_exclude(std::string pattern) { excludes_.push_back(make(std::move(pattern))); }
+
+    bool empty() const { return includes_.empty() && excludes_.empty(); }
+
+    // File admission: no exclude matches, and some include does (or none
+    // were given).  `rel` must be NUL-terminated.
+    bool allows(const char *rel) const;
+
+    // Directory pruning: false when an exclude matches the directory itself.
+    // Includes never prune -- a non-matching directory can still hold
+    // matching files.
+    bool descend(const char *rel) const;
+
+private:
+    struct Pattern {
+        std::string glob;         // empty when `re` is used instead
+        std::regex re;
+        bool is_regex = false;
+        bool matches(const char *rel) const;
+    };
+
+    static Pattern make(std::string pattern);
+
+    std::vector<Pattern> includes_;
+    std::vector<Pattern> excludes_;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#include "govern.h"
+
+#include <chrono>
+#include <thread>
+
+std::size_t MemGovernor::total() const {
+    std::size_t sum = 0;
+    for (const auto &b : bytes_)
+        sum += b.load(std::memory_order_relaxed);
+    return sum;
+}
+
+void MemGovernor::throttle() {
+    if (!enabled())
+        return;
+    while (over_soft() && bytes_[Queue].load(std::memory_order_relaxed) > 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+}
+
+MemGovernor &governor() {
+    static MemGovernor g;
+    return g;
+}
@@ -0,0 +1,52 @@
+#ifndef PARSERCFC_GOVERN_H
+#define PARSERCFC_GOVERN_H
+
+#include <atomic>
+#include <cstddef>
+
+// Memory budget governor behind --mem-limit.  The scalable allocations --
+// queued paths, the sorted-merge entry index, kept -o-bin results and every
+// arena chunk (parse contexts and the intern pool both sit on arenas) --
+// report their bytes here; when the total approaches the budget the walker
+// throttles, the prefetch window shrinks and the shard writers spill their
+// entry index to disk.  On a shared CI host the run degrades to streaming
+// speed instead of getting OOM-killed.
+//
+// With no limit set every check short-circuits; the counters themselves are
+// relaxed atomics bumped only on chunk-sized events.
+class MemGovernor {
+public:
+    enum Component { Queue, Index, Results, Arena, kComponents };
+
+    void set_limit(std::size_t bytes) { limit_ = bytes; }
+    bool enabled() const { return limit_ != 0; }
+
+    void add(Component c, std::size_t n) {
+        bytes_[c].fetch_add(n, std::memory_order_relaxed);
+    }
+    void sub(Component c, std::size_t n) {
+        bytes_[c].fetch_sub(n, std::memory_order_relaxed);
+    }
+    std::size_t total() const;
+
+    // Soft threshold (3/4 of the limit): the producer stops enumerating
+    // until the workers drain what is already queued.
+    bool over_soft() const { return enabled() && total() >= limit_ - limit_ / 4; }
+    // Hard threshold: holders of reclaimable state (the entry index) spill
+    // to disk rather than grow.
+    bool should_spill() const { return enabled() && total() >= limit_; }
+
+    // Producer-side backpressure.  Sleeps while over the soft threshold but
+    // only as long as queued work remains to drain, so progress is always
+    // possible even when unreclaimable state alone exceeds the budget.
+    void throttle();
+
+private:
+    std::atomic<std::size_t> bytes_[kComponents] = {};
+    std::size_t limit_ = 0;
+};
+
+// The one governor; disabled until run_scan applies --mem-limit.
+MemGovernor &governor();
+
+#endif
@@ -0,0 +1,52 @@
+#include "hugepage.h"
+
+#include <atomic>
+#include <cstring>
+
+#include <sys/mman.h>
+
+namespace {
+
+std::atomic<std::size_t> advised_bytes{0};
+
+// AnonHugePages for the whole process, in bytes; 0 when unreadable.
+std::size_t anon_huge_bytes() {
+    std::FILE *f = std::fopen("/proc/self/smaps_rollup", "r");
+    if (!f)
+        return 0;
+    char line[256];
+    std::size_t kb = 0;
+    while (std::fgets(line, sizeof(line), f))
+        if (std::sscanf(line, "AnonHugePages: %zu kB", &kb) == 1)
+            break;
+    std::fclose(f);
+    return kb * 1024;
+}
+
+} // namespace
+
+void *huge_alloc(std::size_t &size) {
+    size = (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return nullptr;
+    // Advisory: on failure (THP disabled, old kernel) the mapping is still
+    // fine, just on 4K pages.
+    madvise(p, size, MADV_HUGEPAGE);
+    advised_bytes.fetch_add(size, std::memory_order_relaxed);
+    return p;
+}
+
+void huge_free(void *p, std::size_t size) {
+    munmap(p, size);
+    advised_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void huge_report(std::FILE *out) {
+    std::fprintf(out, "--- huge pages ---\n");
+    std::fprintf(out, "  %9.1fMB advised (arena chunks)\n",
+                 advised_bytes.load(std::memory_order_relaxed) / 1e6);
+    std::fprintf(out, "  %9.1fMB backed by 2M pages (process-wide)\n",
+                 anon_huge_bytes() / 1e6);
+}
@@ -0,0 +1,25 @@
+#ifndef PARSERCFC_HUGEPAGE_H
+#define PARSERCFC_HUGEPAGE_H
+
+#include <cstddef>
+#include <cstdio>
+
+// Transparent-huge-page allocation layer for memory that every worker
+// hammers: arena chunks sized and aligned to 2 MB so the kernel can back
+// each one with a single TLB entry instead of 512 4K ones.  madvise is
+// advisory -- when THP is off or memory is fragmented the mapping simply
+// stays on small pages, so there is no failure mode beyond plain mmap
+// failing (and the caller falls back to malloc for that).
+
+constexpr std::size_t kHugePageSize = 2u << 20;
+
+// Maps `size` bytes (rounded up to a huge-page multiple, written back) and
+// advises MADV_HUGEPAGE.  Returns nullptr when mmap fails.
+void *huge_alloc(std::size_t &size);
+void huge_free(void *p, std::size_t size);
+
+// --profile line: bytes we advised vs what the kernel actually backed with
+// huge pages (AnonHugePages, process-wide).
+void huge_report(std::FILE *out);
+
+#endif
@@ -0,0 +1,68 @@
+#include "input.h"
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool InputFile::open(const std::string &path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    size_ = (std::size_t)st.st_size;
+    if (size_ == 0) {
+        // Empty file: nothing to map; a non-null data() keeps callers simple.
+        ::close(fd);
+        data_ = "";
+        return true;
+    }
+
+    void *map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+        data_ = (const char *)map;
+        mapped_ = true;
+        ::close(fd);
+        return true;
+    }
+
+    // mmap refused (network fs, odd mount flags): fall back to one read pass.
+    char *buf = (char *)std::malloc(size_);
+    if (!buf) {
+        ::close(fd);
+        size_ = 0;
+        return false;
+    }
+    std::size_t off = 0;
+    while (off < size_) {
+        ssize_t n = ::read(fd, buf + off, size_ - off);
+        if (n <= 0) {
+            std::free(buf);
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        off += (std::size_t)n;
+    }
+    ::close(fd);
+    data_ = buf;
+    return true;
+}
+
+void InputFile::close() {
+    if (mapped_)
+        munmap((void *)data_, size_);
+    else if (data_ && size_ > 0)
+        std::free((void *)data_);
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+}
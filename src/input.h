@@ -0,0 +1,30 @@
+#ifndef PARSERCFC_INPUT_H
+#define PARSERCFC_INPUT_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only view of a source file's bytes.  Prefers mmap so the scanner lexes
+// straight out of the page cache with no copy; falls back to read() into a
+// private buffer for filesystems (or special files) that refuse to map.
+class InputFile {
+public:
+    InputFile() = default;
+    ~InputFile() { close(); }
+    InputFile(const InputFile &) = delete;
+    InputFile &operator=(const InputFile &) = delete;
+
+    // Opens and maps (or reads) `path`.  Returns false on any I/O error.
+    bool open(const std::string &path);
+    void close();
+
+    const char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+    bool mapped_ = false;
+};
+
+#endif
@@ -0,0 +1,32 @@
+#include <cstdio>
+
+#include "binout.h"
+#include "daemon.h"
+#include "options.h"
+#include "profile.h"
+#include "run.h"
+#include "shard.h"
+#include "watch.h"
+
+int main(int argc, char **argv) {
+    Options opt = parse_options(argc, argv);
+
+    if (opt.daemon)
+        return run_daemon(opt);
+    if (opt.submit)
+        return submit_to_daemon(opt);
+    if (opt.watch)
+        return run_watch(opt);
+    if (opt.merge)
+        return run_merge(opt);
+    if (!opt.convert_path.empty())
+        return run_convert(opt);
+
+    if (opt.profile)
+        profiler().enable();
+    RunResult r = run_scan(opt);
+    std::fprintf(stderr, "%s\n", r.summary.c_str());
+    if (opt.profile)
+        profiler().report(stderr);
+    return r.ok ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+#include "numa.h"
+
+#include <dlfcn.h>
+
+namespace {
+
+struct NumaLib {
+    int (*available)() = nullptr;
+    int (*max_node)() = nullptr;
+    int (*run_on_node)(int) = nullptr;
+    void (*set_preferred)(int) = nullptr;
+    int nodes = 1;
+
+    NumaLib() {
+        void *h = dlopen("libnuma.so.1", RTLD_NOW);
+        if (!h)
+            return;
+        available = (int (*)())dlsym(h, "numa_available");
+        max_node = (int (*)())dlsym(h, "numa_max_node");
+        run_on_node = (int (*)(int))dlsym(h, "numa_run_on_node");
+        set_preferred = (void (*)(int))dlsym(h, "numa_set_preferred");
+        if (available && max_node && run_on_node && set_preferred &&
+            available() >= 0)
+            nodes = max_node() + 1;
+    }
+};
+
+const NumaLib &lib() {
+    static const NumaLib instance;
+    return instance;
+}
+
+} // namespace
+
+int numa_node_count() {
+    return lib().nodes;
+}
+
+int numa_node_of_worker(int worker, int workers) {
+    int nodes = numa_node_count();
+    if (nodes <= 1 || workers <= 0)
+        return 0;
+    // Even spread: the first workers/nodes workers on node 0, and so on.
+    return worker * nodes / workers;
+}
+
+void numa_bind_worker(int worker, int workers) {
+    if (numa_node_count() <= 1)
+        return;
+    int node = numa_node_of_worker(worker, workers);
+    lib().run_on_node(node);
+    lib().set_preferred(node);
+}
@@ -0,0 +1,22 @@
+#ifndef PARSERCFC_NUMA_H
+#define PARSERCFC_NUMA_H
+
+// NUMA-aware worker placement.  On multi-socket boxes a naive pool leaves
+// workers chasing mmap'd pages and arena memory across the interconnect;
+// here workers are spread over the nodes, pinned, and told to prefer
+// node-local allocations, and the scheduler steals within a node before
+// crossing it.  libnuma is loaded with dlopen (same arrangement as the zstd
+// support: the .so.1 is widely present, the headers are not), and every
+// entry point degrades to a no-op on single-node or libnuma-less hosts.
+
+// Number of NUMA nodes; 1 whenever NUMA is absent, unavailable or trivial.
+int numa_node_count();
+
+// Node the given worker is assigned to (workers are spread evenly).
+int numa_node_of_worker(int worker, int workers);
+
+// Pins the calling thread to its worker's node and prefers node-local
+// allocation, so the arena and page cache land where the parsing runs.
+void numa_bind_worker(int worker, int workers);
+
+#endif
@@ -0,0 +1,207 @@
+#include "options.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+int default_workers() {
+    int n = static_cast<int>(std::thread::hardware_concurrency());
+    return n > 1 ? n - 1 : 1;
+}
+
+void print_usage(std::FILE *out) {
+    std::fprintf(out,
+        "usage: parsercfc [-h] [-w WORKERS] [-o-fc OUTPUT_FC] [-o-null_fc OUTPUT_NULL_FC] dir\n"
+        "\n"
+        "Collect the names of every C function defined under a directory tree.\n"
+        "Each .c file maps to one JSON object in fc.json; .c files defining no\n"
+        "function are additionally listed in null_fc.json.\n"
+        "\n"
+        "positional arguments:\n"
+        "  dir                   source directory to parse (required)\n"
+        "\n"
+        "options:\n"
+        "  -h, --help            show this help message and exit\n"
+        "  -w WORKERS, --workers WORKERS\n"
+        "                        number of worker threads (default: CPUs-1: %d)\n"
+        "  -o-fc OUTPUT_FC       where to write fc.json (default: ./fc.json)\n"
+        "  -o-null_fc OUTPUT_NULL_FC\n"
+        "                        where to write null_fc.json (default: ./null_fc.json)\n"
+        "  -o-bin OUTPUT_BIN     also write results as an mmap-able binary file\n"
+        "                        (default: off)\n"
+        "  --convert FC_BIN      rewrite an existing fc.bin as the JSON outputs\n"
+        "                        without re-scanning (dir not required; the\n"
+        "                        reverse direction is a scan with -o-bin)\n"
+        "  --cache FILE          reuse parse results across runs, keyed by file\n"
+        "                        content hash (default: no cache)\n"
+        "  --daemon              serve scan requests over a Unix socket with a\n"
+        "                        warm parser (dir not required)\n"
+        "  --submit              send this scan to a running daemon\n"
+        "  --socket PATH         daemon socket (default: /tmp/parsercfc.sock)\n"
+        "  --io-backend BACKEND  mmap (default, best warm) or uring (batched\n"
+        "                        reads, best on a cold page cache)\n"
+        "  --profile             print a per-phase timing breakdown, per-file\n"
+        "                        duration histogram and the slowest files\n"
+        "  --stream              bound the work queue so memory stays flat on\n"
+        "                        arbitrarily large trees (excludes -o-bin)\n"
+        "  --stats FILE          also write per-run analytics (function-count\n"
+        "                        histogram, bytes per function, largest files,\n"
+        "                        per-directory rollups) as JSON\n"
+        "  --mem-limit BYTES     budget for the scan's memory (K/M/G suffix\n"
+        "                        accepted); near it, enumeration throttles and\n"
+        "                        state spills to disk instead of growing\n"
+        "  --compress zstd[:N]   write fc.json.zst / null_fc.json.zst through\n"
+        "                        a zstd encoder at level N (default 3)\n"
+        "  --watch               after a full pass, keep running and re-parse\n"
+        "                        changed .c files via inotify\n"
+        "  --include PATTERN     only parse files whose dir-relative path\n"
+        "                        matches (glob; re:... for regex; repeatable)\n"
+        "  --exclude PATTERN     skip matching files and prune matching\n"
+        "                        directories during enumeration (repeatable)\n"
+        "  --shard I/N           parse the deterministic 1/N slice I of the\n"
+        "                        tree, writing fc.json.I / null_fc.json.I\n"
+        "  --merge               combine shard outputs (and caches) into the\n"
+        "                        canonical files (dir not required)\n",
+        default_workers());
+}
+
+[[noreturn]] void usage_error(const char *msg) {
+    std::fprintf(stderr, "parsercfc: error: %s\n", msg);
+    print_usage(stderr);
+    std::exit(2);
+}
+
+const char *next_arg(int argc, char **argv, int &i, const char *flag) {
+    if (i + 1 >= argc) {
+        std::fprintf(stderr, "parsercfc: error: %s requires an argument\n", flag);
+        std::exit(2);
+    }
+    return argv[++i];
+}
+
+} // namespace
+
+Options parse_options(int argc, char **argv) {
+    Options opt;
+    opt.workers = default_workers();
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0) {
+            print_usage(stdout);
+            std::exit(0);
+        } else if (std::strcmp(arg, "-w") == 0 || std::strcmp(arg, "--workers") == 0) {
+            opt.workers = std::atoi(next_arg(argc, argv, i, arg));
+            if (opt.workers < 1)
+                usage_error("WORKERS must be a positive integer");
+        } else if (std::strcmp(arg, "-o-fc") == 0) {
+            opt.output_fc = next_arg(argc, argv, i, arg);
+        } else if (std::strcmp(arg, "-o-null_fc") == 0) {
+            opt.output_null_fc = next_arg(argc, argv, i, arg);
+        } else if (std::strcmp(arg, "-o-bin") == 0) {
+            opt.output_bin = next_arg(argc, argv, i, arg);
+        } else if (std::strcmp(arg, "--convert") == 0) {
+            opt.convert_path = next_arg(argc, argv, i, arg);
+        } else if (std::strcmp(arg, "--cache") == 0) {
+            opt.cache_path = next_arg(argc, argv, i, arg);
+        } else if (std::strcmp(arg, "--daemon") == 0) {
+            opt.daemon = true;
+        } else if (std::strcmp(arg, "--submit") == 0) {
+            opt.submit = true;
+        } else if (std::strcmp(arg, "--socket") == 0) {
+            opt.socket_path = next_arg(argc, argv, i, arg);
+        } else if (std::strcmp(arg, "--profile") == 0) {
+            opt.profile = true;
+        } else if (std::strcmp(arg, "--stream") == 0) {
+            opt.stream = true;
+        } else if (std::strcmp(arg, "--stats") == 0) {
+            opt.stats_path = next_arg(argc, argv, i, arg);
+        } else if (std::strcmp(arg, "--mem-limit") == 0) {
+            const char *spec = next_arg(argc, argv, i, arg);
+            char *end;
+            unsigned long long v = std::strtoull(spec, &end, 10);
+            std::size_t mult = 1;
+            if (*end == 'k' || *end == 'K')
+                mult = 1ull << 10, ++end;
+            else if (*end == 'm' || *end == 'M')
+                mult = 1ull << 20, ++end;
+            else if (*end == 'g' || *end == 'G')
+                mult = 1ull << 30, ++end;
+            if (end == spec || *end != '\0' || v == 0)
+                usage_error("--mem-limit expects a positive byte count "
+                            "(K/M/G suffix accepted)");
+            opt.mem_limit = (std::size_t)v * mult;
+        } else if (std::strcmp(arg, "--watch") == 0) {
+            opt.watch = true;
+        } else if (std::strcmp(arg, "--shard") == 0) {
+            const char *spec = next_arg(argc, argv, i, arg);
+            char extra;
+            if (std::sscanf(spec, "%d/%d%c", &opt.shard_index, &opt.shard_count,
+                            &extra) != 2 ||
+                opt.shard_count < 1 || opt.shard_index < 0 ||
+                opt.shard_index >= opt.shard_count)
+                usage_error("--shard expects i/n with 0 <= i < n");
+        } else if (std::strcmp(arg, "--merge") == 0) {
+            opt.merge = true;
+        } else if (std::strcmp(arg, "--include") == 0) {
+            opt.includes.push_back(next_arg(argc, argv, i, arg));
+        } else if (std::strcmp(arg, "--exclude") == 0) {
+            opt.excludes.push_back(next_arg(argc, argv, i, arg));
+        } else if (std::strcmp(arg, "--compress") == 0) {
+            const char *spec = next_arg(argc, argv, i, arg);
+            if (std::strcmp(spec, "zstd") == 0) {
+                opt.zstd_level = 3;
+            } else if (std::strncmp(spec, "zstd:", 5) == 0) {
+                opt.zstd_level = std::atoi(spec + 5);
+                if (opt.zstd_level < 1 || opt.zstd_level > 19)
+                    usage_error("--compress zstd level must be 1..19");
+            } else {
+                usage_error("--compress only supports zstd[:level]");
+            }
+        } else if (std::strcmp(arg, "--io-backend") == 0) {
+            const char *backend = next_arg(argc, argv, i, arg);
+            if (std::strcmp(backend, "mmap") == 0)
+                opt.io_backend = Options::IoBackend::Mmap;
+            else if (std::strcmp(backend, "uring") == 0)
+                opt.io_backend = Options::IoBackend::Uring;
+            else
+                usage_error("--io-backend must be mmap or uring");
+        } else if (arg[0] == '-' && arg[1] != '\0') {
+            usage_error("unrecognized option");
+        } else if (opt.dir.empty()) {
+            opt.dir = arg;
+        } else {
+            usage_error("multiple directories given; exactly one is expected");
+        }
+    }
+
+    if (opt.dir.empty() && !opt.daemon && !opt.merge && opt.convert_path.empty())
+        usage_error("the following arguments are required: dir");
+    if (!opt.convert_path.empty() &&
+        (opt.daemon || opt.submit || opt.watch || opt.merge ||
+         opt.shard_count || opt.zstd_level || !opt.dir.empty()))
+        usage_error("--convert rewrites an existing fc.bin and excludes "
+                    "scanning and the other modes");
+    if (opt.shard_count && (opt.daemon || opt.submit || opt.watch || opt.merge))
+        usage_error("--shard only applies to a one-shot scan");
+    if (opt.merge && (opt.daemon || opt.submit || opt.watch || opt.zstd_level))
+        usage_error("--merge combines plain shard outputs and excludes "
+                    "--daemon, --submit, --watch and --compress");
+    if (opt.daemon && opt.submit)
+        usage_error("--daemon and --submit are mutually exclusive");
+    if (opt.stream && !opt.output_bin.empty())
+        usage_error("--stream and -o-bin are mutually exclusive "
+                    "(-o-bin keeps every result in memory)");
+    if (opt.watch && (opt.daemon || opt.submit || opt.zstd_level ||
+                      !opt.output_bin.empty()))
+        usage_error("--watch writes plain fc.json/null_fc.json and excludes "
+                    "--daemon, --submit, --compress and -o-bin");
+    if (opt.watch && (opt.profile || !opt.stats_path.empty() || opt.mem_limit ||
+                      opt.io_backend != Options::IoBackend::Mmap))
+        usage_error("--watch re-parses in-process and does not support "
+                    "--profile, --stats, --mem-limit or --io-backend");
+    return opt;
+}
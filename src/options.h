@@ -0,0 +1,64 @@
+#ifndef PARSERCFC_OPTIONS_H
+#define PARSERCFC_OPTIONS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Command-line options for parsercfc.  Defaults follow the requirements doc:
+// workers defaults to (online CPUs - 1), outputs land in the current directory.
+struct Options {
+    std::string dir;
+    int workers = 0;
+    std::string output_fc = "fc.json";
+    std::string output_null_fc = "null_fc.json";
+    // Binary mmap-able results (see binout.h); empty disables.
+    std::string output_bin;
+    // --convert: an existing fc.bin to rewrite as the JSON outputs without
+    // re-scanning; empty disables.
+    std::string convert_path;
+    // Content-hash parse cache file; empty disables caching.
+    std::string cache_path;
+    // Daemon mode: --daemon serves scans over socket_path, --submit sends
+    // this invocation's dir/outputs to a running daemon instead of scanning.
+    bool daemon = false;
+    bool submit = false;
+    std::string socket_path = "/tmp/parsercfc.sock";
+    // How file bytes reach the scanner.  mmap wins on a warm page cache;
+    // uring batches reads per worker and wins cold.
+    enum class IoBackend { Mmap, Uring };
+    IoBackend io_backend = IoBackend::Mmap;
+    // Per-phase timing breakdown printed at end of run (see profile.h).
+    bool profile = false;
+    // Bounded-memory mode: enumeration blocks on a capped work queue, so
+    // RSS stays flat no matter how large the tree is.
+    bool stream = false;
+    // --compress zstd[:level]: write fc.json.zst / null_fc.json.zst through
+    // a per-worker zstd encoder.  0 means uncompressed output.
+    int zstd_level = 0;
+    // Watch mode: stay running, re-parse changed files via inotify and keep
+    // the outputs current (see watch.h).
+    bool watch = false;
+    // --include/--exclude patterns pushed down into enumeration (filter.h);
+    // globs by default, `re:` prefix for regex, matched against dir-relative
+    // paths.
+    std::vector<std::string> includes;
+    std::vector<std::string> excludes;
+    // --stats output path for the columnar statistics pass (stats.h);
+    // empty disables collection entirely.
+    std::string stats_path;
+    // --mem-limit byte budget for the scan's scalable state (govern.h);
+    // 0 means no budget.
+    std::size_t mem_limit = 0;
+    // --shard i/n farm partitioning and --merge recombination (shard.h).
+    // shard_count == 0 means no sharding.
+    int shard_index = 0;
+    int shard_count = 0;
+    bool merge = false;
+};
+
+// Parses argv into an Options struct.  Prints usage and exits on -h/--help or
+// on a malformed command line.
+Options parse_options(int argc, char **argv);
+
+#endif
@@ -0,0 +1,378 @@
+#include "output.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "govern.h"
+
+namespace {
+
+// Approximate heap footprint of one index record, for budget accounting.
+std::size_t index_bytes(const EntryRec &rec) {
+    return sizeof(EntryRec) + rec.path.size();
+}
+
+// Under --stream the index is drained every this-many records, so the
+// resident part stays a few hundred KB per worker no matter the tree size.
+constexpr std::size_t kStreamSpillBatch = 4096;
+
+} // namespace
+
+void append_json_string(std::string &out, std::string_view s) {
+    out += '"';
+    for (unsigned char c : s) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b";  break;
+        case '\f': out += "\\f";  break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += (char)c;
+            }
+        }
+    }
+    out += '"';
+}
+
+bool ShardWriter::open(const std::string &fc_base, const std::string &null_base, int id,
+                       int zstd_level, bool stream) {
+    stream_ = stream;
+    fc_path_ = fc_base + ".shard" + std::to_string(id);
+    null_path_ = null_base + ".shard" + std::to_string(id);
+    fc_ = std::fopen(fc_path_.c_str(), "wb");
+    null_ = std::fopen(null_path_.c_str(), "wb");
+    if (!fc_ || !null_) {
+        std::fprintf(stderr, "parsercfc: cannot create shard files for worker %d\n", id);
+        close();
+        return false;
+    }
+    // Clear any spill index a crashed earlier run left behind.
+    unlink((fc_path_ + ".idx").c_str());
+    unlink((null_path_ + ".idx").c_str());
+    zstd_level_ = zstd_level;
+    if (zstd_level_ &&
+        (!fc_z_.open(fc_, zstd_level_) || !null_z_.open(null_, zstd_level_))) {
+        std::fprintf(stderr, "parsercfc: cannot start zstd stream for worker %d\n", id);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ShardWriter::emit(std::FILE *f, ZstdStream &z, bool &first,
+                       std::vector<EntryRec> &recs, std::uint64_t &off,
+                       const std::string &path, std::string &entry) {
+    if (zstd_level_) {
+        entry.insert(0, first ? "\n    " : ",\n    ");
+        first = false;
+        z.write(entry.data(), entry.size());
+        return;
+    }
+    std::fwrite(entry.data(), 1, entry.size(), f);
+    recs.push_back(EntryRec{path, off, (std::uint32_t)entry.size()});
+    governor().add(MemGovernor::Index, index_bytes(recs.back()));
+    off += entry.size();
+}
+
+void ShardWriter::add(const FileResult &result) {
+    std::string entry;
+    append_json_string(entry, result.path);
+    entry += ": {\"fc\": [";
+    for (std::size_t i = 0; i < result.functions.size(); ++i) {
+        if (i)
+            entry += ", ";
+        append_json_string(entry, result.functions[i]);
+    }
+    entry += "]}";
+    emit(fc_, fc_z_, fc_first_, fc_recs_, fc_off_, result.path, entry);
+
+    if (result.functions.empty()) {
+        std::string line;
+        append_json_string(line, result.path);
+        emit(null_, null_z_, null_first_, null_recs_, null_off_, result.path, line);
+    }
+
+    if (zstd_level_)
+        return;
+    if (governor().should_spill()) {
+        spill(fc_recs_, fc_idx_, fc_path_);
+        spill(null_recs_, null_idx_, null_path_);
+    } else if (stream_) {
+        // --stream promises flat memory without a --mem-limit, so the index
+        // goes out in fixed batches instead of waiting for pressure.
+        if (fc_recs_.size() >= kStreamSpillBatch)
+            spill(fc_recs_, fc_idx_, fc_path_);
+        if (null_recs_.size() >= kStreamSpillBatch)
+            spill(null_recs_, null_idx_, null_path_);
+    }
+}
+
+// Drains the in-memory index to `<shard>.idx` (u32 path length, u64 offset,
+// u32 entry length, path bytes per record) and releases its budget share.
+void ShardWriter::spill(std::vector<EntryRec> &recs, std::FILE *&idx,
+                        const std::string &shard_path) {
+    if (recs.empty())
+        return;
+    if (!idx) {
+        std::string path = shard_path + ".idx";
+        idx = std::fopen(path.c_str(), "wb");
+        if (!idx)
+            return;
+    }
+    std::size_t freed = 0;
+    for (const EntryRec &rec : recs) {
+        std::uint32_t plen = (std::uint32_t)rec.path.size();
+        std::fwrite(&plen, sizeof(plen), 1, idx);
+        std::fwrite(&rec.off, sizeof(rec.off), 1, idx);
+        std::fwrite(&rec.len, sizeof(rec.len), 1, idx);
+        std::fwrite(rec.path.data(), 1, plen, idx);
+        freed += index_bytes(rec);
+    }
+    recs.clear();
+    recs.shrink_to_fit();
+    governor().sub(MemGovernor::Index, freed);
+}
+
+std::vector<EntryRec> ShardWriter::take_records(std::vector<EntryRec> &recs,
+                                                std::FILE *&idx,
+                                                const std::string &shard_path) {
+    std::vector<EntryRec> out;
+    if (idx) {
+        std::fclose(idx);
+        idx = nullptr;
+    }
+    std::string path = shard_path + ".idx";
+    std::FILE *f = std::fopen(path.c_str(), "rb");
+    if (f) {
+        for (;;) {
+            EntryRec rec;
+            std::uint32_t plen;
+            if (std::fread(&plen, sizeof(plen), 1, f) != 1 ||
+                std::fread(&rec.off, sizeof(rec.off), 1, f) != 1 ||
+                std::fread(&rec.len, sizeof(rec.len), 1, f) != 1)
+                break;
+            rec.path.resize(plen);
+            if (std::fread(&rec.path[0], 1, plen, f) != plen)
+                break;
+            out.push_back(std::move(rec));
+        }
+        std::fclose(f);
+        unlink(path.c_str());
+    }
+    // Whatever never spilled stays accounted until here; the merge holds it
+    // only after the parse phase has released its memory.
+    std::size_t freed = 0;
+    for (const EntryRec &rec : recs)
+        freed += index_bytes(rec);
+    governor().sub(MemGovernor::Index, freed);
+    out.insert(out.end(), std::make_move_iterator(recs.begin()),
+               std::make_move_iterator(recs.end()));
+    recs.clear();
+    return out;
+}
+
+std::vector<EntryRec> ShardWriter::take_fc_records() {
+    return take_records(fc_recs_, fc_idx_, fc_path_);
+}
+
+std::vector<EntryRec> ShardWriter::take_null_records() {
+    return take_records(null_recs_, null_idx_, null_path_);
+}
+
+bool ShardWriter::close() {
+    bool ok = true;
+    if (zstd_level_) {
+        ok = fc_z_.finish() && ok;
+        ok = null_z_.finish() && ok;
+    }
+    if (fc_) {
+        ok = std::fclose(fc_) == 0 && ok;
+        fc_ = nullptr;
+    }
+    if (null_) {
+        ok = std::fclose(null_) == 0 && ok;
+        null_ = nullptr;
+    }
+    if (fc_idx_) {
+        ok = std::fclose(fc_idx_) == 0 && ok;
+        fc_idx_ = nullptr;
+    }
+    if (null_idx_) {
+        ok = std::fclose(null_idx_) == 0 && ok;
+        null_idx_ = nullptr;
+    }
+    return ok;
+}
+
+namespace {
+
+// Kernel-side copy of fd_in's remaining bytes (from `off`) into fd_out.
+bool splice_fd(int fd_in, off_t off, off_t len, int fd_out) {
+    while (off < len) {
+        ssize_t n = copy_file_range(fd_in, &off, fd_out, nullptr,
+                                    (size_t)(len - off), 0);
+        if (n > 0)
+            continue;
+        if (n < 0 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS)) {
+            // Filesystem can't do it kernel-side: plain read/write loop.
+            char buf[1 << 16];
+            if (lseek(fd_in, off, SEEK_SET) < 0)
+                return false;
+            ssize_t r;
+            while ((r = read(fd_in, buf, sizeof(buf))) > 0) {
+                ssize_t w = 0;
+                while (w < r) {
+                    ssize_t m = write(fd_out, buf + w, (size_t)(r - w));
+                    if (m < 0)
+                        return false;
+                    w += m;
+                }
+            }
+            return r == 0;
+        }
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+namespace {
+
+// Writes `text` to `out`, as-is or as one small zstd frame.
+bool write_snippet(int out, const char *text, int zstd_level) {
+    std::string bytes;
+    if (zstd_level) {
+        if (!zstd_compress_frame(text, bytes, zstd_level))
+            return false;
+    } else {
+        bytes = text;
+    }
+    return write(out, bytes.data(), bytes.size()) == (ssize_t)bytes.size();
+}
+
+} // namespace
+
+bool merge_shards(const std::string &out_path,
+                  const std::vector<std::string> &shards,
+                  const char *head, const char *tail, int zstd_level) {
+    int out = open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        std::fprintf(stderr, "parsercfc: cannot write %s\n", out_path.c_str());
+        return false;
+    }
+    bool ok = write_snippet(out, head, zstd_level);
+    bool first = true;
+    for (const std::string &shard : shards) {
+        int in = open(shard.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0) {
+            ok = false;
+            continue;
+        }
+        struct stat st;
+        if (fstat(in, &st) == 0 && st.st_size > 0) {
+            if (!first)
+                ok = write_snippet(out, ",", zstd_level) && ok;
+            first = false;
+            ok = splice_fd(in, 0, st.st_size, out) && ok;
+        }
+        ::close(in);
+        if (ok)
+            unlink(shard.c_str());
+    }
+    ok = write_snippet(out, tail, zstd_level) && ok;
+    ok = ::close(out) == 0 && ok;
+    return ok;
+}
+
+bool merge_sorted(const std::string &out_path,
+                  const std::vector<std::string> &shards,
+                  std::vector<std::vector<EntryRec>> recs,
+                  const char *head, const char *tail) {
+    // Each worker's run sorts in its own thread; the k-way merge below then
+    // walks k sorted runs, so the serial part is a linear pass.
+    {
+        std::vector<std::thread> sorters;
+        for (std::vector<EntryRec> &r : recs)
+            if (r.size() > 1)
+                sorters.emplace_back([&r] {
+                    std::sort(r.begin(), r.end(),
+                              [](const EntryRec &a, const EntryRec &b) {
+                                  return a.path < b.path;
+                              });
+                });
+        for (std::thread &t : sorters)
+            t.join();
+    }
+
+    std::vector<int> fds(shards.size(), -1);
+    bool ok = true;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        fds[i] = open(shards[i].c_str(), O_RDONLY | O_CLOEXEC);
+        if (fds[i] < 0)
+            ok = false;
+    }
+    std::FILE *out = std::fopen(out_path.c_str(), "wb");
+    if (!out) {
+        std::fprintf(stderr, "parsercfc: cannot write %s\n", out_path.c_str());
+        for (int fd : fds)
+            if (fd >= 0)
+                ::close(fd);
+        return false;
+    }
+    std::fputs(head, out);
+
+    std::vector<size_t> at(recs.size(), 0);
+    const std::string *prev = nullptr;
+    bool first = true;
+    std::string buf;
+    for (;;) {
+        int best = -1;
+        for (size_t i = 0; i < recs.size(); ++i)
+            if (at[i] < recs[i].size() &&
+                (best < 0 || recs[i][at[i]].path < recs[best][at[best]].path))
+                best = (int)i;
+        if (best < 0)
+            break;
+        const EntryRec &e = recs[best][at[best]++];
+        // The same path can reach two workers (e.g. a hard link walked
+        // twice); keep the first copy and drop the rest.
+        if (prev && *prev == e.path)
+            continue;
+        prev = &e.path;
+        std::fputs(first ? "\n    " : ",\n    ", out);
+        first = false;
+        buf.resize(e.len);
+        if (fds[best] < 0 ||
+            pread(fds[best], buf.data(), e.len, (off_t)e.off) != (ssize_t)e.len) {
+            ok = false;
+            continue;
+        }
+        std::fwrite(buf.data(), 1, buf.size(), out);
+    }
+
+    std::fputs(tail, out);
+    ok = std::fclose(out) == 0 && ok;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        if (fds[i] >= 0)
+            ::close(fds[i]);
+        if (ok)
+            unlink(shards[i].c_str());
+    }
+    return ok;
+}
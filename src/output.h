@@ -0,0 +1,106 @@
+#ifndef PARSERCFC_OUTPUT_H
+#define PARSERCFC_OUTPUT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "analyze.h"
+#include "compress.h"
+
+// Appends `s` to `out` as a JSON string literal (quotes included).
+void append_json_string(std::string &out, std::string_view s);
+
+// Where one serialized entry landed inside a worker's shard file.  The
+// sorted merge orders these by path without rereading or reparsing the
+// entry bytes themselves.
+struct EntryRec {
+    std::string path;
+    std::uint64_t off = 0;
+    std::uint32_t len = 0;
+};
+
+// Per-worker streaming output.  Results are written as they are produced to
+// two private shard files (fc entries and null paths), so nothing about the
+// run accumulates in memory beyond one EntryRec per entry -- and under
+// --stream not even that: the index is spilled to a side file in small
+// batches, keeping the run itself O(1) per worker.  Plain shards
+// hold bare entries back to back and the writer records each entry's
+// offset; merge_sorted then reassembles them in global path order.  With
+// zstd_level > 0 a shard is an independent zstd frame (first entry
+// prefixed "\n    ", later ones ",\n    ") that the merge glues on without
+// recompressing -- frames cannot be reordered, so compressed output keeps
+// arrival order.
+class ShardWriter {
+public:
+    ~ShardWriter() { close(); }
+
+    // Creates `<fc_base>.shard<id>` and `<null_base>.shard<id>`.  With
+    // `stream` set the entry index is spilled to disk as it grows instead
+    // of being held for the whole run (--stream's flat-memory guarantee).
+    bool open(const std::string &fc_base, const std::string &null_base, int id,
+              int zstd_level = 0, bool stream = false);
+    void add(const FileResult &result);
+    bool close();
+
+    const std::string &fc_shard_path() const { return fc_path_; }
+    const std::string &null_shard_path() const { return null_path_; }
+
+    // Entry index for merge_sorted (plain mode only; empty under zstd).
+    // Under --stream or --mem-limit pressure the index may have been
+    // spilled to a side file during the run; these reload it, which is safe
+    // because by merge time the parse-phase memory has been released.
+    std::vector<EntryRec> take_fc_records();
+    std::vector<EntryRec> take_null_records();
+
+private:
+    void emit(std::FILE *f, ZstdStream &z, bool &first,
+              std::vector<EntryRec> &recs, std::uint64_t &off,
+              const std::string &path, std::string &entry);
+    void spill(std::vector<EntryRec> &recs, std::FILE *&idx,
+               const std::string &shard_path);
+    std::vector<EntryRec> take_records(std::vector<EntryRec> &recs,
+                                       std::FILE *&idx,
+                                       const std::string &shard_path);
+
+    std::FILE *fc_ = nullptr;
+    std::FILE *null_ = nullptr;
+    std::string fc_path_;
+    std::string null_path_;
+    ZstdStream fc_z_;
+    ZstdStream null_z_;
+    int zstd_level_ = 0;
+    bool stream_ = false;
+    bool fc_first_ = true;
+    bool null_first_ = true;
+    std::vector<EntryRec> fc_recs_;
+    std::vector<EntryRec> null_recs_;
+    std::uint64_t fc_off_ = 0;
+    std::uint64_t null_off_ = 0;
+    std::FILE *fc_idx_ = nullptr;
+    std::FILE *null_idx_ = nullptr;
+};
+
+// Concatenates the non-empty shards between `head` and `tail`, inserting a
+// "," separator between them.  Uses copy_file_range so shard bytes move
+// kernel-side without touching user space; falls back to a read/write loop
+// where the filesystem refuses.  With zstd_level > 0 the shards are already
+// zstd frames and head/separator/tail are written as tiny frames of their
+// own.  Shard files are removed on success.
+bool merge_shards(const std::string &out_path,
+                  const std::vector<std::string> &shards,
+                  const char *head, const char *tail, int zstd_level = 0);
+
+// Sorted, deduplicated merge of plain shards: each shard's EntryRec run is
+// sorted by path in its own thread, then a k-way merge writes the entries
+// between `head` and `tail` in global path order, dropping repeats of the
+// same path.  Output is byte-identical regardless of worker count or
+// scheduling.  Shard files are removed on success.
+bool merge_sorted(const std::string &out_path,
+                  const std::vector<std::string> &shards,
+                  std::vector<std::vector<EntryRec>> recs,
+                  const char *head, const char *tail);
+
+#endif
@@ -0,0 +1,591 @@
+/* C grammar for parsercfc.
+ *
+ * Derived from the classic ANSI/C11 yacc grammar, reduced to what function
+ * name extraction needs: declarations and declarators carry the defined
+ * identifier up to function_definition, everything else is recognized and
+ * discarded.  Built %define api.pure full so one process can run one parse
+ * per worker thread; all mutable state lives in the ParseContext threaded
+ * through %param.
+ *
+ * Typedef names are disambiguated with the usual lexer hack: init_declarator
+ * registers names into ctx->typedefs while ctx->in_typedef is set, and the
+ * scanner consults that set before classifying an identifier.
+ */
+
+%define api.pure full
+%define parse.error verbose
+%param {ParseContext *ctx}
+%expect 1 /* _Atomic '(' prefers atomic_type_specifier */
+
+%{
+#include <cstdio>
+#include <cstring>
+#include "parse.h"
+#include "lexer.h"
+#include "../strpool.h"
+
+// Per-file syntax error budget; past it the rest of the file is not worth
+// further grammar work (see the external_declaration error rule).
+static const int kErrorBudget = 25;
+
+static void record_function(ParseContext *ctx, const char *name);
+static void register_typedef(ParseContext *ctx, const char *name);
+static void begin_body_skip(ParseContext *ctx);
+static void yyerror(ParseContext *ctx, const char *msg);
+%}
+
+%union {
+    const char *str;
+    int flag;
+}
+
+%token <str> IDENTIFIER TYPEDEF_NAME
+%token I_CONSTANT F_CONSTANT STRING_LITERAL FUNC_NAME
+%token PTR_OP INC_OP DEC_OP LEFT_OP RIGHT_OP LE_OP GE_OP EQ_OP NE_OP
+%token AND_OP OR_OP MUL_ASSIGN DIV_ASSIGN MOD_ASSIGN ADD_ASSIGN SUB_ASSIGN
+%token LEFT_ASSIGN RIGHT_ASSIGN AND_ASSIGN XOR_ASSIGN OR_ASSIGN ELLIPSIS
+
+%token TYPEDEF EXTERN STATIC AUTO REGISTER INLINE
+%token CONST RESTRICT VOLATILE ATOMIC
+%token BOOL CHAR SHORT INT LONG SIGNED UNSIGNED FLOAT DOUBLE VOID COMPLEX IMAGINARY
+%token STRUCT UNION ENUM
+%token CASE DEFAULT IF ELSE SWITCH WHILE DO FOR GOTO CONTINUE BREAK RETURN SIZEOF
+%token ALIGNAS ALIGNOF GENERIC NORETURN STATIC_ASSERT THREAD_LOCAL
+%token TYPEOF_EXPR /* typeof(...) / __typeof__(...), consumed whole by the scanner */
+
+%type <str> declarator direct_declarator init_declarator
+
+%start translation_unit
+
+%%
+
+primary_expression
+    : IDENTIFIER
+    | constant
+    | string
+    | '(' expression ')'
+    | generic_selection
+    ;
+
+constant
+    : I_CONSTANT
+    | F_CONSTANT
+    ;
+
+string
+    : STRING_LITERAL
+    | FUNC_NAME
+    | string STRING_LITERAL
+    ;
+
+generic_selection
+    : GENERIC '(' assignment_expression ',' generic_assoc_list ')'
+    ;
+
+generic_assoc_list
+    : generic_association
+    | generic_assoc_list ',' generic_association
+    ;
+
+generic_association
+    : type_name ':' assignment_expression
+    | DEFAULT ':' assignment_expression
+    ;
+
+postfix_expression
+    : primary_expression
+    | postfix_expression '[' expression ']'
+    | postfix_expression '(' ')'
+    | postfix_expression '(' argument_expression_list ')'
+    | postfix_expression '.' IDENTIFIER
+    | postfix_expression PTR_OP IDENTIFIER
+    | postfix_expression INC_OP
+    | postfix_expression DEC_OP
+    | '(' type_name ')' '{' initializer_list '}'
+    | '(' type_name ')' '{' initializer_list ',' '}'
+    ;
+
+argument_expression_list
+    : assignment_expression
+    | argument_expression_list ',' assignment_expression
+    ;
+
+unary_expression
+    : postfix_expression
+    | INC_OP unary_expression
+    | DEC_OP unary_expression
+    | unary_operator cast_expression
+    | SIZEOF unary_expression
+    | SIZEOF '(' type_name ')'
+    | ALIGNOF '(' type_name ')'
+    ;
+
+unary_operator
+    : '&'
+    | '*'
+    | '+'
+    | '-'
+    | '~'
+    | '!'
+    ;
+
+cast_expression
+    : unary_expression
+    | '(' type_name ')' cast_expression
+    ;
+
+multiplicative_expression
+    : cast_expression
+    | multiplicative_expression '*' cast_expression
+    | multiplicative_expression '/' cast_expression
+    | multiplicative_expression '%' cast_expression
+    ;
+
+additive_expression
+    : multiplicative_expression
+    | additive_expression '+' multiplicative_expression
+    | additive_expression '-' multiplicative_expression
+    ;
+
+shift_expression
+    : additive_expression
+    | shift_expression LEFT_OP additive_expression
+    | shift_expression RIGHT_OP additive_expression
+    ;
+
+relational_expression
+    : shift_expression
+    | relational_expression '<' shift_expression
+    | relational_expression '>' shift_expression
+    | relational_expression LE_OP shift_expression
+    | relational_expression GE_OP shift_expression
+    ;
+
+equality_expression
+    : relational_expression
+    | equality_expression EQ_OP relational_expression
+    | equality_expression NE_OP relational_expression
+    ;
+
+and_expression
+    : equality_expression
+    | and_expression '&' equality_expression
+    ;
+
+exclusive_or_expression
+    : and_expression
+    | exclusive_or_expression '^' and_expression
+    ;
+
+inclusive_or_expression
+    : exclusive_or_expression
+    | inclusive_or_expression '|' exclusive_or_expression
+    ;
+
+logical_and_expression
+    : inclusive_or_expression
+    | logical_and_expression AND_OP inclusive_or_expression
+    ;
+
+logical_or_expression
+    : logical_and_expression
+    | logical_or_expression OR_OP logical_and_expression
+    ;
+
+conditional_expression
+    : logical_or_expression
+    | logical_or_expression '?' expression ':' conditional_expression
+    ;
+
+assignment_expression
+    : conditional_expression
+    | unary_expression assignment_operator assignment_expression
+    ;
+
+assignment_operator
+    : '='
+    | MUL_ASSIGN
+    | DIV_ASSIGN
+    | MOD_ASSIGN
+    | ADD_ASSIGN
+    | SUB_ASSIGN
+    | LEFT_ASSIGN
+    | RIGHT_ASSIGN
+    | AND_ASSIGN
+    | XOR_ASSIGN
+    | OR_ASSIGN
+    ;
+
+expression
+    : assignment_expression
+    | expression ',' assignment_expression
+    ;
+
+constant_expression
+    : conditional_expression
+    ;
+
+declaration
+    : declaration_specifiers ';'               { ctx->in_typedef = false; }
+    | declaration_specifiers init_declarator_list ';'
+                                               { ctx->in_typedef = false; }
+    | static_assert_declaration
+    ;
+
+declaration_specifiers
+    : declaration_specifier
+    | declaration_specifiers declaration_specifier
+    ;
+
+declaration_specifier
+    : storage_class_specifier
+    | type_specifier
+    | type_qualifier
+    | function_specifier
+    | alignment_specifier
+    ;
+
+init_declarator_list
+    : init_declarator
+    | init_declarator_list ',' init_declarator
+    ;
+
+init_declarator
+    : declarator '=' initializer               { $$ = $1; }
+    | declarator
+        {
+            $$ = $1;
+            if (ctx->in_typedef)
+                register_typedef(ctx, $1);
+        }
+    ;
+
+storage_class_specifier
+    : TYPEDEF                                  { ctx->in_typedef = true; }
+    | EXTERN
+    | STATIC
+    | THREAD_LOCAL
+    | AUTO
+    | REGISTER
+    ;
+
+type_specifier
+    : VOID
+    | CHAR
+    | SHORT
+    | INT
+    | LONG
+    | FLOAT
+    | DOUBLE
+    | SIGNED
+    | UNSIGNED
+    | BOOL
+    | COMPLEX
+    | IMAGINARY
+    | atomic_type_specifier
+    | struct_or_union_specifier
+    | enum_specifier
+    | TYPEDEF_NAME
+    | TYPEOF_EXPR
+    ;
+
+struct_or_union_specifier
+    : struct_or_union '{' struct_declaration_list '}'
+    | struct_or_union IDENTIFIER '{' struct_declaration_list '}'
+    | struct_or_union IDENTIFIER
+    | struct_or_union TYPEDEF_NAME '{' struct_declaration_list '}'
+    | struct_or_union TYPEDEF_NAME
+    ;
+
+struct_or_union
+    : STRUCT
+    | UNION
+    ;
+
+struct_declaration_list
+    : struct_declaration
+    | struct_declaration_list struct_declaration
+    ;
+
+struct_declaration
+    : specifier_qualifier_list ';'
+    | specifier_qualifier_list struct_declarator_list ';'
+    | static_assert_declaration
+    ;
+
+specifier_qualifier_list
+    : type_specifier specifier_qualifier_list
+    | type_specifier
+    | type_qualifier specifier_qualifier_list
+    | type_qualifier
+    ;
+
+struct_declarator_list
+    : struct_declarator
+    | struct_declarator_list ',' struct_declarator
+    ;
+
+struct_declarator
+    : ':' constant_expression
+    | declarator ':' constant_expression
+    | declarator
+    ;
+
+enum_specifier
+    : ENUM '{' enumerator_list '}'
+    | ENUM '{' enumerator_list ',' '}'
+    | ENUM IDENTIFIER '{' enumerator_list '}'
+    | ENUM IDENTIFIER '{' enumerator_list ',' '}'
+    | ENUM IDENTIFIER
+    | ENUM TYPEDEF_NAME
+    ;
+
+enumerator_list
+    : enumerator
+    | enumerator_list ',' enumerator
+    ;
+
+enumerator
+    : IDENTIFIER '=' constant_expression
+    | IDENTIFIER
+    ;
+
+atomic_type_specifier
+    : ATOMIC '(' type_name ')'
+    ;
+
+type_qualifier
+    : CONST
+    | RESTRICT
+    | VOLATILE
+    | ATOMIC
+    ;
+
+function_specifier
+    : INLINE
+    | NORETURN
+    ;
+
+alignment_specifier
+    : ALIGNAS '(' type_name ')'
+    | ALIGNAS '(' constant_expression ')'
+    ;
+
+declarator
+    : pointer direct_declarator                { $$ = $2; }
+    | direct_declarator                        { $$ = $1; }
+    ;
+
+direct_declarator
+    : IDENTIFIER                               { $$ = $1; }
+    | '(' declarator ')'                       { $$ = $2; }
+    | direct_declarator '[' ']'                                    { $$ = $1; }
+    | direct_declarator '[' assignment_expression ']'              { $$ = $1; }
+    | direct_declarator '[' '*' ']'                                { $$ = $1; }
+    | direct_declarator '[' type_qualifier_list ']'                { $$ = $1; }
+    | direct_declarator '[' type_qualifier_list assignment_expression ']' { $$ = $1; }
+    | direct_declarator '[' type_qualifier_list '*' ']'            { $$ = $1; }
+    | direct_declarator '[' STATIC assignment_expression ']'       { $$ = $1; }
+    | direct_declarator '[' STATIC type_qualifier_list assignment_expression ']' { $$ = $1; }
+    | direct_declarator '[' type_qualifier_list STATIC assignment_expression ']' { $$ = $1; }
+    | direct_declarator '(' parameter_type_list ')'                { $$ = $1; }
+    | direct_declarator '(' ')'                                    { $$ = $1; }
+    | direct_declarator '(' identifier_list ')'                    { $$ = $1; }
+    ;
+
+pointer
+    : '*' type_qualifier_list pointer
+    | '*' type_qualifier_list
+    | '*' pointer
+    | '*'
+    ;
+
+type_qualifier_list
+    : type_qualifier
+    | type_qualifier_list type_qualifier
+    ;
+
+parameter_type_list
+    : parameter_list ',' ELLIPSIS
+    | parameter_list
+    ;
+
+parameter_list
+    : parameter_declaration
+    | parameter_list ',' parameter_declaration
+    ;
+
+parameter_declaration
+    : declaration_specifiers declarator
+    | declaration_specifiers abstract_declarator
+    | declaration_specifiers
+    ;
+
+identifier_list
+    : IDENTIFIER
+    | identifier_list ',' IDENTIFIER
+    ;
+
+type_name
+    : specifier_qualifier_list abstract_declarator
+    | specifier_qualifier_list
+    ;
+
+abstract_declarator
+    : pointer direct_abstract_declarator
+    | pointer
+    | direct_abstract_declarator
+    ;
+
+direct_abstract_declarator
+    : '(' abstract_declarator ')'
+    | '[' ']'
+    | '[' '*' ']'
+    | '[' assignment_expression ']'
+    | '[' type_qualifier_list ']'
+    | '[' type_qualifier_list assignment_expression ']'
+    | '[' STATIC assignment_expression ']'
+    | '[' STATIC type_qualifier_list assignment_expression ']'
+    | '[' type_qualifier_list STATIC assignment_expression ']'
+    | direct_abstract_declarator '[' ']'
+    | direct_abstract_declarator '[' '*' ']'
+    | direct_abstract_declarator '[' assignment_expression ']'
+    | direct_abstract_declarator '[' type_qualifier_list ']'
+    | direct_abstract_declarator '[' type_qualifier_list assignment_expression ']'
+    | direct_abstract_declarator '[' STATIC assignment_expression ']'
+    | direct_abstract_declarator '[' STATIC type_qualifier_list assignment_expression ']'
+    | direct_abstract_declarator '[' type_qualifier_list STATIC assignment_expression ']'
+    | '(' ')'
+    | '(' parameter_type_list ')'
+    | direct_abstract_declarator '(' ')'
+    | direct_abstract_declarator '(' parameter_type_list ')'
+    ;
+
+initializer
+    : '{' initializer_list '}'
+    | '{' initializer_list ',' '}'
+    | '{' '}'
+    | assignment_expression
+    ;
+
+initializer_list
+    : designation initializer
+    | initializer
+    | initializer_list ',' designation initializer
+    | initializer_list ',' initializer
+    ;
+
+designation
+    : designator_list '='
+    ;
+
+designator_list
+    : designator
+    | designator_list designator
+    ;
+
+designator
+    : '[' constant_expression ']'
+    | '.' IDENTIFIER
+    ;
+
+static_assert_declaration
+    : STATIC_ASSERT '(' constant_expression ',' string ')' ';'
+    | STATIC_ASSERT '(' constant_expression ')' ';'
+    ;
+
+translation_unit
+    : external_declaration
+    | translation_unit external_declaration
+    ;
+
+/* Recovery is bounded by construction: instead of Bison's token-at-a-time
+ * discard (quadratic on pathological input), the error action jumps the
+ * scanner to the next top-level sync point in one raw pass, and once a file
+ * burns through its error budget the scanner reports EOF so the parse
+ * finishes with whatever was extracted so far.
+ */
+external_declaration
+    : function_definition
+    | declaration
+    | ';'
+    | error
+        {
+            ctx->in_typedef = false;
+            /* A stray ';' or '}' lookahead (unbalanced #if blocks, mostly)
+             * is itself the sync point: dropping it is the whole recovery. */
+            bool at_sync = yychar == ';' || yychar == '}';
+            yyclearin;
+            if (ctx->error_count > kErrorBudget)
+                ctx->lexer->give_up();
+            else if (!at_sync)
+                ctx->lexer->recover_to_sync_point();
+            yyerrok;
+        }
+    ;
+
+function_definition
+    : declaration_specifiers declarator declaration_list function_body
+        { record_function(ctx, $2); }
+    | declaration_specifiers declarator function_body
+        { record_function(ctx, $2); }
+    | declarator declaration_list function_body
+        { record_function(ctx, $1); }
+    | declarator function_body
+        { record_function(ctx, $1); }
+    ;
+
+/* parsercfc only needs the declarator; the body contributes nothing.  The
+ * body_start reduction is a consistent state (no lookahead needed), so the
+ * scanner can be flipped into a raw brace-matching skip before it lexes a
+ * single body token -- the matching '}' is the only token it hands back.
+ */
+function_body
+    : body_start '}'
+    ;
+
+body_start
+    : '{'    { begin_body_skip(ctx); }
+    ;
+
+declaration_list
+    : declaration
+    | declaration_list declaration
+    ;
+
+%%
+
+static void record_function(ParseContext *ctx, const char *name) {
+    // Re-home the arena-interned spelling in the process-wide pool: the
+    // result list outlives this parse, the arena does not.
+    if (name && *name)
+        ctx->functions.push_back(string_pool().intern(name));
+}
+
+static void register_typedef(ParseContext *ctx, const char *name) {
+    // `name` is arena-interned, so the view stays valid for the whole parse.
+    if (name && *name)
+        ctx->typedefs.emplace(std::string_view(name));
+}
+
+static void begin_body_skip(ParseContext *ctx) {
+    ctx->lexer->begin_body_skip();
+}
+
+static void yyerror(ParseContext *ctx, const char *msg) {
+    (void)msg;
+    ctx->error_count++;
+}
+
+bool parse_source(ParseContext &ctx, const char *data, std::size_t size) {
+    Lexer lexer(ctx, data, size);
+    ctx.lexer = &lexer;
+    ctx.functions.clear();
+    ctx.typedefs.clear();
+    ctx.arena.reset();
+    ctx.in_typedef = false;
+    ctx.error_count = 0;
+    int rc = yyparse(&ctx);
+    ctx.lexer = nullptr;
+    return rc != 2; /* 2 == parser ran out of memory */
+}
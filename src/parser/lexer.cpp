@@ -0,0 +1,384 @@
+#include "parse.h"
+#include "lexer.h"
+#include "c.tab.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+inline bool ident_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+inline bool ident_char(char c) {
+    return ident_start(c) || (c >= '0' && c <= '9');
+}
+inline bool digit(char c) { return c >= '0' && c <= '9'; }
+
+// Keyword table, including the GCC spellings that dominate kernel and BSP
+// trees.  Classification is the hottest operation in the scanner, so it is
+// a perfect hash rather than a map: three characters and the length feed a
+// multiply/xor mix whose 256-slot table holds each keyword exactly once,
+// and a lookup is one hash, one index and one string compare.  The
+// multipliers below were searched offline for this exact keyword set; the
+// constexpr constructor re-verifies perfection on every compile, so adding
+// a keyword that collides fails the build instead of misclassifying.
+struct Keyword {
+    std::string_view text;
+    int token;
+};
+
+constexpr Keyword kKeywords[] = {
+    {"auto", AUTO}, {"break", BREAK}, {"case", CASE}, {"char", CHAR},
+    {"const", CONST}, {"continue", CONTINUE}, {"default", DEFAULT},
+    {"do", DO}, {"double", DOUBLE}, {"else", ELSE}, {"enum", ENUM},
+    {"extern", EXTERN}, {"float", FLOAT}, {"for", FOR}, {"goto", GOTO},
+    {"if", IF}, {"inline", INLINE}, {"int", INT}, {"long", LONG},
+    {"register", REGISTER}, {"restrict", RESTRICT}, {"return", RETURN},
+    {"short", SHORT}, {"signed", SIGNED}, {"sizeof", SIZEOF},
+    {"static", STATIC}, {"struct", STRUCT}, {"switch", SWITCH},
+    {"typedef", TYPEDEF}, {"union", UNION}, {"unsigned", UNSIGNED},
+    {"void", VOID}, {"volatile", VOLATILE}, {"while", WHILE},
+    {"_Bool", BOOL}, {"_Complex", COMPLEX}, {"_Imaginary", IMAGINARY},
+    {"_Atomic", ATOMIC}, {"_Alignas", ALIGNAS}, {"_Alignof", ALIGNOF},
+    {"_Generic", GENERIC}, {"_Noreturn", NORETURN},
+    {"_Static_assert", STATIC_ASSERT}, {"static_assert", STATIC_ASSERT},
+    {"_Thread_local", THREAD_LOCAL}, {"__thread", THREAD_LOCAL},
+    /* GCC aliases */
+    {"__const", CONST}, {"__const__", CONST},
+    {"__volatile", VOLATILE}, {"__volatile__", VOLATILE},
+    {"__restrict", RESTRICT}, {"__restrict__", RESTRICT},
+    {"__inline", INLINE}, {"__inline__", INLINE},
+    {"__signed", SIGNED}, {"__signed__", SIGNED},
+    {"__complex__", COMPLEX},
+    {"__alignof", ALIGNOF}, {"__alignof__", ALIGNOF},
+    {"__func__", FUNC_NAME}, {"__FUNCTION__", FUNC_NAME},
+    {"__PRETTY_FUNCTION__", FUNC_NAME},
+};
+constexpr std::size_t kKeywordCount = sizeof(kKeywords) / sizeof(*kKeywords);
+
+// Valid for n >= 2; every keyword is at least two characters.
+constexpr unsigned keyword_hash(std::string_view w) {
+    unsigned c0 = (unsigned char)w[0];
+    unsigned c2 = w.size() > 2 ? (unsigned char)w[2] : 0u;
+    unsigned cp = (unsigned char)w[w.size() - 2];
+    return ((c0 * 51245u) ^ (c2 * 12035u) ^ (cp * 8443u) ^
+            ((unsigned)w.size() * 19949u)) & 255u;
+}
+
+struct KeywordIndex {
+    unsigned char slot[256];
+
+    constexpr KeywordIndex() : slot{} {
+        for (auto &s : slot)
+            s = 0xff;
+        for (std::size_t i = 0; i < kKeywordCount; ++i) {
+            unsigned h = keyword_hash(kKeywords[i].text);
+            if (slot[h] != 0xff)
+                throw "keyword hash is no longer perfect";
+            slot[h] = (unsigned char)i;
+        }
+    }
+};
+
+constexpr KeywordIndex kKeywordIndex{};
+
+inline int keyword_token(std::string_view word) {
+    if (word.size() < 2)
+        return 0;
+    unsigned char i = kKeywordIndex.slot[keyword_hash(word)];
+    if (i != 0xff && kKeywords[i].text == word)
+        return kKeywords[i].token;
+    return 0;
+}
+
+} // namespace
+
+void Lexer::skip_line() {
+    while (cur_ < end_ && *cur_ != '\n') {
+        if (*cur_ == '\\' && cur_ + 1 < end_ && cur_[1] == '\n')
+            ++cur_;
+        ++cur_;
+    }
+}
+
+void Lexer::skip_block_comment() {
+    cur_ += 2;
+    while (cur_ + 1 < end_ && !(cur_[0] == '*' && cur_[1] == '/'))
+        ++cur_;
+    cur_ = cur_ + 2 < end_ ? cur_ + 2 : end_;
+}
+
+// Consumes whitespace/comments and then one balanced (...) group, if present.
+// Used to swallow __attribute__((...)), asm("..."), typeof(...) arguments.
+void Lexer::skip_balanced_parens() {
+    for (;;) {
+        while (cur_ < end_ && (*cur_ == ' ' || *cur_ == '\t' || *cur_ == '\n' || *cur_ == '\r'))
+            ++cur_;
+        if (cur_ + 1 < end_ && cur_[0] == '/' && cur_[1] == '*') {
+            skip_block_comment();
+            continue;
+        }
+        break;
+    }
+    if (cur_ >= end_ || *cur_ != '(')
+        return;
+    int depth = 0;
+    while (cur_ < end_) {
+        char c = *cur_;
+        if (c == '(') {
+            ++depth;
+        } else if (c == ')') {
+            if (--depth == 0) { ++cur_; return; }
+        } else if (c == '"' || c == '\'') {
+            char quote = c;
+            ++cur_;
+            while (cur_ < end_ && *cur_ != quote) {
+                if (*cur_ == '\\') ++cur_;
+                ++cur_;
+            }
+        } else if (c == '/' && cur_ + 1 < end_ && cur_[1] == '*') {
+            skip_block_comment();
+            continue;
+        }
+        ++cur_;
+    }
+}
+
+void Lexer::string_literal(char quote) {
+    while (cur_ < end_ && *cur_ != quote) {
+        if (*cur_ == '\\' && cur_ + 1 < end_)
+            ++cur_;
+        ++cur_;
+    }
+    if (cur_ < end_)
+        ++cur_;
+}
+
+int Lexer::identifier(YYSTYPE *lval) {
+    const char *start = cur_;
+    while (cur_ < end_ && ident_char(*cur_))
+        ++cur_;
+    std::string_view word(start, (std::size_t)(cur_ - start));
+
+    // Wide/UTF string and char prefixes: lex the literal as one token.
+    if (cur_ < end_ && (*cur_ == '"' || *cur_ == '\'') &&
+        (word == "L" || word == "u" || word == "U" || word == "u8")) {
+        char quote = *cur_++;
+        string_literal(quote);
+        return quote == '"' ? STRING_LITERAL : I_CONSTANT;
+    }
+
+    // Extension noise that carries no grammar weight: drop it and the
+    // parenthesized payload, then hand back the following token.
+    if (word == "__attribute__" || word == "__attribute" ||
+        word == "__asm__" || word == "__asm" || word == "asm") {
+        skip_balanced_parens();
+        return next(lval);
+    }
+    if (word == "__extension__")
+        return next(lval);
+    if (word == "typeof" || word == "__typeof" || word == "__typeof__") {
+        skip_balanced_parens();
+        return TYPEOF_EXPR;
+    }
+
+    if (int token = keyword_token(word))
+        return token;
+
+    lval->str = ctx_.intern(start, cur_ - start);
+    // Member accesses and goto labels are never type names even when the
+    // spelling collides with a typedef.
+    if (prev_token_ != '.' && prev_token_ != PTR_OP && prev_token_ != GOTO &&
+        ctx_.typedefs.count(word))
+        return TYPEDEF_NAME;
+    return IDENTIFIER;
+}
+
+// Discards body bytes up to the '}' matching the already-shifted '{'.  This
+// is where >90% of the input bytes go: one pass of brace counting that stays
+// aware of comments, literals, and preprocessor lines, never building tokens.
+int Lexer::skip_body() {
+    int depth = 1;
+    while (cur_ < end_) {
+        char c = *cur_;
+        switch (c) {
+        case '{':
+            ++depth;
+            break;
+        case '}':
+            if (--depth == 0) {
+                ++cur_;
+                return prev_token_ = '}';
+            }
+            break;
+        case '"':
+        case '\'':
+            ++cur_;
+            string_literal(c);
+            continue;
+        case '/':
+            if (cur_ + 1 < end_ && cur_[1] == '*') {
+                skip_block_comment();
+                continue;
+            }
+            if (cur_ + 1 < end_ && cur_[1] == '/') {
+                skip_line();
+                continue;
+            }
+            break;
+        case '#':
+            // Directive lines may hold unbalanced braces (#if 0 blocks,
+            // brace-valued macros); their bytes must not count.
+            if (cur_[-1] == '\n') {
+                skip_line();
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+        ++cur_;
+    }
+    return 0; /* unterminated body: let the parser report it at EOF */
+}
+
+// Resynchronizes after a syntax error: a top-level ';' ends the broken
+// declaration, a '{' starts a body whose matching '}' ends it -- either way
+// the next token the parser sees is a plausible external-declaration start.
+// Stray '}' (the usual aftermath of unbalanced conditional compilation) is
+// swallowed too.  Pure byte scanning, so a file full of garbage costs one
+// linear pass no matter how many errors it raises.
+void Lexer::recover_to_sync_point() {
+    skip_body_ = false;
+    prev_token_ = 0;
+    while (cur_ < end_) {
+        char c = *cur_;
+        switch (c) {
+        case ';':
+            ++cur_;
+            return;
+        case '{':
+            ++cur_;
+            skip_body();
+            return;
+        case '}':
+            ++cur_;
+            return;
+        case '"':
+        case '\'':
+            ++cur_;
+            string_literal(c);
+            continue;
+        case '/':
+            if (cur_ + 1 < end_ && cur_[1] == '*') {
+                skip_block_comment();
+                continue;
+            }
+            if (cur_ + 1 < end_ && cur_[1] == '/') {
+                skip_line();
+                continue;
+            }
+            break;
+        case '#':
+            if (cur_[-1] == '\n') {
+                skip_line();
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+        ++cur_;
+    }
+}
+
+int Lexer::next(YYSTYPE *lval) {
+    if (skip_body_) {
+        skip_body_ = false;
+        return skip_body();
+    }
+    while (cur_ < end_) {
+        char c = *cur_;
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f') {
+            ++cur_;
+            continue;
+        }
+        if (c == '/' && cur_ + 1 < end_ && cur_[1] == '*') {
+            skip_block_comment();
+            continue;
+        }
+        if (c == '/' && cur_ + 1 < end_ && cur_[1] == '/') {
+            skip_line();
+            continue;
+        }
+        if (c == '#') {
+            // Preprocessor directive: parsercfc analyzes unpreprocessed
+            // source, so the whole (possibly continued) line is dropped.
+            skip_line();
+            continue;
+        }
+
+        if (ident_start(c))
+            return prev_token_ = identifier(lval);
+
+        if (digit(c) || (c == '.' && cur_ + 1 < end_ && digit(cur_[1]))) {
+            bool is_float = (c == '.');
+            ++cur_;
+            // pp-number: greedily take everything a C numeric literal can
+            // contain; exponent signs need their e/E/p/P lookbehind.
+            while (cur_ < end_) {
+                char d = *cur_;
+                if (ident_char(d) || d == '.') {
+                    if (d == '.' || d == 'e' || d == 'E' || d == 'p' || d == 'P')
+                        is_float = is_float || d == '.';
+                    ++cur_;
+                } else if ((d == '+' || d == '-') &&
+                           (cur_[-1] == 'e' || cur_[-1] == 'E' ||
+                            cur_[-1] == 'p' || cur_[-1] == 'P')) {
+                    is_float = true;
+                    ++cur_;
+                } else {
+                    break;
+                }
+            }
+            return prev_token_ = is_float ? F_CONSTANT : I_CONSTANT;
+        }
+
+        if (c == '"' || c == '\'') {
+            ++cur_;
+            string_literal(c);
+            return prev_token_ = (c == '"' ? STRING_LITERAL : I_CONSTANT);
+        }
+
+        // Multi-character punctuators, longest first.
+        const char *p = cur_;
+        std::size_t left = (std::size_t)(end_ - p);
+        struct Punct { const char *text; int len; int token; };
+        static const Punct puncts[] = {
+            {"...", 3, ELLIPSIS}, {"<<=", 3, LEFT_ASSIGN}, {">>=", 3, RIGHT_ASSIGN},
+            {"->", 2, PTR_OP}, {"++", 2, INC_OP}, {"--", 2, DEC_OP},
+            {"<<", 2, LEFT_OP}, {">>", 2, RIGHT_OP}, {"<=", 2, LE_OP},
+            {">=", 2, GE_OP}, {"==", 2, EQ_OP}, {"!=", 2, NE_OP},
+            {"&&", 2, AND_OP}, {"||", 2, OR_OP}, {"*=", 2, MUL_ASSIGN},
+            {"/=", 2, DIV_ASSIGN}, {"%=", 2, MOD_ASSIGN}, {"+=", 2, ADD_ASSIGN},
+            {"-=", 2, SUB_ASSIGN}, {"&=", 2, AND_ASSIGN}, {"^=", 2, XOR_ASSIGN},
+            {"|=", 2, OR_ASSIGN},
+        };
+        for (const Punct &pt : puncts) {
+            if (left >= (std::size_t)pt.len && std::memcmp(p, pt.text, pt.len) == 0) {
+                cur_ += pt.len;
+                return prev_token_ = pt.token;
+            }
+        }
+        ++cur_;
+        return prev_token_ = (unsigned char)c;
+    }
+    return 0;
+}
+
+int yylex(YYSTYPE *lval, ParseContext *ctx) {
+    return ctx->lexer->next(lval);
+}
@@ -0,0 +1,59 @@
+#ifndef PARSERCFC_PARSER_LEXER_H
+#define PARSERCFC_PARSER_LEXER_H
+
+#include <cstddef>
+
+struct ParseContext;
+union YYSTYPE;
+
+// Reentrant C scanner over an in-memory buffer.  All state lives in the
+// instance, so each worker thread owns its own Lexer and no two parses share
+// anything mutable.  The token set and semantics mirror what a
+// `%option reentrant` Flex scanner for C would produce; it is hand-written so
+// the input is consumed straight from the caller's buffer with no copy.
+class Lexer {
+public:
+    Lexer(ParseContext &ctx, const char *data, std::size_t size)
+        : ctx_(ctx), cur_(data), end_(data + size) {}
+
+    // Returns the next token kind (a c.tab.h token constant or a single-char
+    // punctuator), storing the spelling for identifier-like tokens in *lval.
+    // Returns 0 at end of input.
+    int next(YYSTYPE *lval);
+
+    // Arms the function-body fast path: the next call to next() discards the
+    // remainder of the current '{'...'}' group (comment- and string-aware
+    // brace counting, no tokenization) and returns the closing '}'.
+    void begin_body_skip() { skip_body_ = true; }
+
+    // Panic-mode resynchronization: discards input at raw-scan speed (same
+    // comment/string/directive awareness as skip_body) up to the next
+    // top-level ';' or past the next balanced '{'...'}' group, whichever
+    // comes first.  The grammar's error rule calls this instead of letting
+    // Bison pop tokens one at a time.
+    void recover_to_sync_point();
+
+    // Error budget exhausted: pretend the input ends here so the parser
+    // accepts whatever it has and the file is emitted best-effort.
+    void give_up() { cur_ = end_; skip_body_ = false; }
+
+private:
+    int identifier(YYSTYPE *lval);
+    void skip_line();                 // to end of line, honoring \-continuations
+    void skip_block_comment();
+    void skip_balanced_parens();      // after __attribute__, asm, typeof, ...
+    void string_literal(char quote);
+
+    ParseContext &ctx_;
+    int skip_body();
+
+    const char *cur_;
+    const char *end_;
+    int prev_token_ = 0;              // disambiguates TYPEDEF_NAME contexts
+    bool skip_body_ = false;
+};
+
+// Scanner entry point in the shape Bison's %param-based pure parser calls.
+int yylex(YYSTYPE *lval, ParseContext *ctx);
+
+#endif
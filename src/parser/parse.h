@@ -0,0 +1,50 @@
+#ifndef PARSERCFC_PARSER_PARSE_H
+#define PARSERCFC_PARSER_PARSE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "../arena.h"
+
+class Lexer;
+
+// Parse state shared between the reentrant scanner and the pure Bison
+// parser.  One ParseContext is private to the worker thread running the
+// parse, which is what lets N parses proceed concurrently in one process.
+// Contexts are pooled: a worker keeps one for its lifetime and parse_source
+// rebinds it per file, so the containers and arena amortize across the
+// hundreds of thousands of files a worker may see.
+struct ParseContext {
+    Lexer *lexer = nullptr;
+    const char *path = nullptr;
+
+    // Function names recorded by function_definition reductions, source
+    // order.  The pointers are StringPool-interned so they outlive the parse.
+    std::vector<const char *> functions;
+
+    // Names introduced by `typedef`, consulted by the scanner so it can
+    // return TYPEDEF_NAME instead of IDENTIFIER (the classic lexer hack).
+    // The views point into `arena`, so the set holds no storage of its own.
+    std::unordered_set<std::string_view> typedefs;
+    bool in_typedef = false;
+
+    int error_count = 0;
+
+    // Backing storage for token spellings handed to the parser; rewound
+    // (not freed) when the next parse starts.
+    Arena arena;
+
+    const char *intern(const char *s, std::size_t n) {
+        return arena.copy(s, n);
+    }
+};
+
+// Parses `size` bytes of C source and fills ctx->functions with the names of
+// every function defined in it.  Returns false only if the parse aborted
+// outright (out of memory); syntax errors are counted in ctx->error_count.
+bool parse_source(ParseContext &ctx, const char *data, std::size_t size);
+
+#endif
@@ -0,0 +1,111 @@
+#include "prefetch.h"
+
+#include <chrono>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+// Items queued past this are beyond any useful readahead horizon: by the
+// time the workers get there the kernel would long since have evicted the
+// pages we pulled in.  add() drops the mirror copy instead of growing
+// without bound (--stream keeps the real queue capped; this one follows).
+constexpr std::size_t kMaxQueued = 16384;
+
+void advise(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    // Kicks off asynchronous readahead and returns immediately; the actual
+    // I/O overlaps with whatever the parse workers are chewing on now.
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+}
+
+} // namespace
+
+void Prefetcher::start(std::size_t budget_bytes) {
+    budget_ = budget_bytes;
+    started_ = true;
+    thread_ = std::thread(&Prefetcher::run, this);
+}
+
+void Prefetcher::add(std::string path, std::size_t bytes) {
+    if (!started_)
+        return;
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.size() >= kMaxQueued)
+            return;
+        was_empty = queue_.empty();
+        queue_.push_back(Item{std::move(path), bytes});
+    }
+    // Wake only on the empty-to-nonempty edge; a per-file notify would cost
+    // a context switch per push on a busy box.
+    if (was_empty)
+        cv_.notify_one();
+}
+
+void Prefetcher::consumed(std::size_t bytes) {
+    if (!started_)
+        return;
+    ahead_.fetch_sub((std::int64_t)bytes, std::memory_order_relaxed);
+    if (budget_waiting_.load(std::memory_order_relaxed)) {
+        // Same handshake as the scheduler's wakeups: touching the mutex
+        // pairs with run()'s wait so the decrement cannot be missed.
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        cv_.notify_one();
+    }
+}
+
+void Prefetcher::close() {
+    if (!started_)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    cv_.notify_all();
+}
+
+void Prefetcher::stop() {
+    if (!started_)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        // Anything still queued is for files the workers already parsed the
+        // slow way; advising them now would be pure noise.
+        queue_.clear();
+    }
+    cv_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+    started_ = false;
+}
+
+void Prefetcher::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this] { return !queue_.empty() || closed_; });
+        if (queue_.empty())
+            return;
+        if (ahead_.load(std::memory_order_relaxed) > (std::int64_t)budget_) {
+            // Window full: park until the workers report enough consumption.
+            // The timeout covers a consumed() racing past before the flag
+            // was visible; stop() clears the queue to break us out for good.
+            budget_waiting_.store(true, std::memory_order_relaxed);
+            cv_.wait_for(lock, std::chrono::milliseconds(10));
+            budget_waiting_.store(false, std::memory_order_relaxed);
+            continue;
+        }
+        Item item = std::move(queue_.front());
+        queue_.pop_front();
+        ahead_.fetch_add((std::int64_t)item.bytes, std::memory_order_relaxed);
+        lock.unlock();
+        advise(item.path);
+        lock.lock();
+    }
+}
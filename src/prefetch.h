@@ -0,0 +1,59 @@
+#ifndef PARSERCFC_PREFETCH_H
+#define PARSERCFC_PREFETCH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Readahead stage keyed off the work queue.  The producer mirrors every
+// scheduled file here; a dedicated thread runs ahead of the parse workers
+// issuing posix_fadvise(WILLNEED) so the kernel pulls the pages in while
+// earlier files are still being parsed, and on a cold cache the workers
+// stop eating major faults serially.  The window is byte-budgeted: once
+// advised-but-unparsed bytes exceed the budget the thread waits for the
+// workers to catch up, so we never ask for more than comfortably fits in
+// free page cache.
+class Prefetcher {
+public:
+    ~Prefetcher() { stop(); }
+
+    void start(std::size_t budget_bytes);
+    // Producer side: mirror of WorkScheduler::push.  Wakes the thread only
+    // on an empty-to-nonempty transition.
+    void add(std::string path, std::size_t bytes);
+    // Worker side: `bytes` of previously scheduled input were parsed.  A
+    // relaxed atomic decrement on the hot path; the cv is touched only when
+    // the thread is actually parked on the budget.
+    void consumed(std::size_t bytes);
+    // No more add() calls; the thread drains what is queued and exits.
+    void close();
+    void stop();
+
+private:
+    struct Item {
+        std::string path;
+        std::size_t bytes;
+    };
+
+    void run();
+
+    std::deque<Item> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+    // Advised minus consumed; may dip negative (cached or never-advised
+    // files), which only widens the window.
+    std::atomic<std::int64_t> ahead_{0};
+    // True while run() is parked waiting for the window to reopen.
+    std::atomic<bool> budget_waiting_{false};
+    std::size_t budget_ = 0;
+    bool closed_ = false;
+    bool started_ = false;
+};
+
+#endif
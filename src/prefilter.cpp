@@ -0,0 +1,115 @@
+#include "prefilter.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Stage 1: vectorized scan for the mere presence of '(' and '{'.  Generated
+// tables, data blobs and config stubs usually fail this within the first few
+// cache lines, which is the whole point: most null files never reach the
+// byte-level state machine below, let alone the parser.
+bool has_paren_and_brace(const char *data, std::size_t size) {
+    bool paren = false, brace = false;
+    std::size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i vparen = _mm_set1_epi8('(');
+    const __m128i vbrace = _mm_set1_epi8('{');
+    for (; i + 16 <= size && !(paren && brace); i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(data + i));
+        paren = paren || _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vparen));
+        brace = brace || _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vbrace));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t vparen = vdupq_n_u8('(');
+    const uint8x16_t vbrace = vdupq_n_u8('{');
+    for (; i + 16 <= size && !(paren && brace); i += 16) {
+        uint8x16_t chunk = vld1q_u8((const uint8_t *)(data + i));
+        paren = paren || vmaxvq_u8(vceqq_u8(chunk, vparen));
+        brace = brace || vmaxvq_u8(vceqq_u8(chunk, vbrace));
+    }
+#endif
+    for (; i < size && !(paren && brace); ++i) {
+        paren = paren || data[i] == '(';
+        brace = brace || data[i] == '{';
+    }
+    return paren && brace;
+}
+
+inline bool ident_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+}
+
+// Stage 2: one comment/string/preprocessor-aware pass confirming the shape
+// `identifier ( ... ) ... {`.  Deliberately conservative: any doubt means
+// "might define a function" and the file goes to the real parser.
+bool has_definition_shape(const char *data, std::size_t size) {
+    bool after_ident = false;   // last code byte was an identifier byte
+    bool seen_params = false;   // identifier '(' ... ')' completed
+    int paren = 0;              // depth of a group opened after an identifier
+    std::size_t i = 0;
+
+    while (i < size) {
+        char c = data[i];
+        if (c == '/' && i + 1 < size && data[i + 1] == '*') {
+            i += 2;
+            while (i + 1 < size && !(data[i] == '*' && data[i + 1] == '/')) ++i;
+            i += 2;
+            continue;
+        }
+        if (c == '/' && i + 1 < size && data[i + 1] == '/') {
+            while (i < size && data[i] != '\n') ++i;
+            continue;
+        }
+        if (c == '"' || c == '\'') {
+            char quote = c;
+            ++i;
+            while (i < size && data[i] != quote) {
+                if (data[i] == '\\') ++i;
+                ++i;
+            }
+            ++i;
+            after_ident = false;
+            continue;
+        }
+        if (c == '#' && (i == 0 || data[i - 1] == '\n')) {
+            while (i < size && data[i] != '\n') {
+                if (data[i] == '\\' && i + 1 < size && data[i + 1] == '\n') ++i;
+                ++i;
+            }
+            continue;
+        }
+
+        if (c == '(' && (after_ident || paren > 0)) {
+            ++paren;
+        } else if (c == ')' && paren > 0) {
+            if (--paren == 0)
+                seen_params = true;
+        } else if (c == '{' && seen_params) {
+            return true;
+        }
+
+        if (ident_char(c))
+            after_ident = true;
+        else if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+            after_ident = false;
+        ++i;
+    }
+    // EOF with a group still open means the scan lost sync (an unmatched
+    // '(' inside a disabled #if block, say) and everything after that point
+    // was invisible to it.  That is doubt, not proof of emptiness: send the
+    // file to the real parser, whose recovery path copes.  Misrouting here
+    // costs one wasted parse; the other direction silently drops results.
+    return paren > 0;
+}
+
+} // namespace
+
+bool may_define_function(const char *data, std::size_t size) {
+    return has_paren_and_brace(data, size) && has_definition_shape(data, size);
+}
@@ -0,0 +1,13 @@
+#ifndef PARSERCFC_PREFILTER_H
+#define PARSERCFC_PREFILTER_H
+
+#include <cstddef>
+
+// Cheap necessary-condition check run before a scanner is ever built: a C
+// function definition needs an identifier, a '(' ... ')' group and a '{'
+// outside comments and string literals.  Returns false only when the buffer
+// provably contains no definition, so a false here routes the file straight
+// to null_fc.json; true means "parse it to find out".
+bool may_define_function(const char *data, std::size_t size);
+
+#endif
@@ -0,0 +1,77 @@
+#include "profile.h"
+
+#include <algorithm>
+
+#include "hugepage.h"
+
+namespace {
+
+const char *phase_name(Phase p) {
+    switch (p) {
+    case Phase::Enumerate: return "enumerate";
+    case Phase::Read:      return "read";
+    case Phase::Prefilter: return "prefilter";
+    case Phase::Parse:     return "parse";
+    case Phase::Emit:      return "emit";
+    case Phase::kCount:    break;
+    }
+    return "?";
+}
+
+// Log-spaced buckets for the per-file histogram; the last one is open-ended.
+const uint64_t kBucketNs[] = {
+    10'000, 100'000, 1'000'000, 10'000'000, 100'000'000,
+};
+const char *const kBucketLabel[] = {
+    "   <10us", "  <100us", "    <1ms", "   <10ms", "  <100ms", " >=100ms",
+};
+
+} // namespace
+
+Profiler &profiler() {
+    static Profiler instance;
+    return instance;
+}
+
+void Profiler::record_file(const std::string &path, uint64_t ns) {
+    std::lock_guard<std::mutex> guard(files_mutex_);
+    files_.emplace_back(path, ns);
+}
+
+void Profiler::report(std::FILE *out) {
+    uint64_t grand = 0;
+    for (const auto &t : totals_)
+        grand += t.load(std::memory_order_relaxed);
+
+    std::fprintf(out, "--- profile (worker-seconds per phase) ---\n");
+    for (int p = 0; p < (int)Phase::kCount; ++p) {
+        uint64_t ns = totals_[p].load(std::memory_order_relaxed);
+        std::fprintf(out, "  %-10s %9.3fs  %5.1f%%\n", phase_name((Phase)p),
+                     ns / 1e9, grand ? 100.0 * ns / grand : 0.0);
+    }
+
+    huge_report(out);
+
+    std::lock_guard<std::mutex> guard(files_mutex_);
+    if (files_.empty())
+        return;
+
+    size_t buckets[sizeof(kBucketLabel) / sizeof(*kBucketLabel)] = {};
+    for (const auto &f : files_) {
+        size_t b = 0;
+        while (b < sizeof(kBucketNs) / sizeof(*kBucketNs) && f.second >= kBucketNs[b])
+            ++b;
+        ++buckets[b];
+    }
+    std::fprintf(out, "--- per-file duration histogram ---\n");
+    for (size_t b = 0; b < sizeof(kBucketLabel) / sizeof(*kBucketLabel); ++b)
+        std::fprintf(out, "  %s  %zu\n", kBucketLabel[b], buckets[b]);
+
+    size_t top = std::min<size_t>(10, files_.size());
+    std::partial_sort(files_.begin(), files_.begin() + top, files_.end(),
+                      [](const auto &a, const auto &b) { return a.second > b.second; });
+    std::fprintf(out, "--- slowest files ---\n");
+    for (size_t i = 0; i < top; ++i)
+        std::fprintf(out, "  %9.3fms  %s\n", files_[i].second / 1e6,
+                     files_[i].first.c_str());
+}
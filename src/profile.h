@@ -0,0 +1,73 @@
+#ifndef PARSERCFC_PROFILE_H
+#define PARSERCFC_PROFILE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Per-phase wall-clock accounting behind --profile.  Disabled is the common
+// case and costs one predictable branch per scope: PhaseScope reads a plain
+// bool set once before the workers start and never touches a clock when it
+// is false.  When enabled, phase totals go to relaxed atomics and per-file
+// durations to a mutex-guarded list -- the contention is the price of asking.
+enum class Phase {
+    Enumerate,  // directory walk
+    Read,       // open/mmap/io_uring until bytes are in memory
+    Prefilter,  // SIMD pre-filter + cache hash/lookup
+    Parse,      // lex + parse
+    Emit,       // shard writes and final merges
+    kCount
+};
+
+class Profiler {
+public:
+    void enable() { enabled_ = true; }
+    bool enabled() const { return enabled_; }
+
+    void add(Phase p, uint64_t ns) {
+        totals_[(int)p].fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    void record_file(const std::string &path, uint64_t ns);
+
+    // Breakdown table, duration histogram, and the slowest files, to `out`.
+    void report(std::FILE *out);
+
+private:
+    bool enabled_ = false;
+    std::atomic<uint64_t> totals_[(int)Phase::kCount] = {};
+    std::mutex files_mutex_;
+    std::vector<std::pair<std::string, uint64_t>> files_;
+};
+
+Profiler &profiler();
+
+inline int64_t profile_now_ns() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+// Scope guard adding its lifetime to one phase bucket.  Cheap enough for the
+// per-file hot path; free (one branch) when --profile was not given.
+class PhaseScope {
+public:
+    explicit PhaseScope(Phase p) : phase_(p) {
+        if (profiler().enabled())
+            start_ = profile_now_ns();
+    }
+    ~PhaseScope() {
+        if (start_)
+            profiler().add(phase_, (uint64_t)(profile_now_ns() - start_));
+    }
+    PhaseScope(const PhaseScope &) = delete;
+    PhaseScope &operator=(const PhaseScope &) = delete;
+
+private:
+    Phase phase_;
+    int64_t start_ = 0;
+};
+
+#endif
@@ -0,0 +1,482 @@
+#include "run.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "analyze.h"
+#include "binout.h"
+#include "cache.h"
+#include "filter.h"
+#include "govern.h"
+#include "numa.h"
+#include "output.h"
+#include "prefetch.h"
+#include "profile.h"
+#include "scheduler.h"
+#include "shard.h"
+#include "stats.h"
+#include "uring.h"
+#include "walker.h"
+
+namespace {
+
+// Per-event counters bumped from the workers' hot loop.  Each worker owns a
+// cache-line-padded block (same trick as the scheduler's per-worker state),
+// so the 2-4 increments per file never ping-pong a line between cores; the
+// display thread and the final summary pay for the summing instead.  All
+// updates are relaxed: nothing orders against them, the display only
+// samples, and the final totals are read after the joins (which synchronize
+// everything).
+struct alignas(64) WorkerCounters {
+    std::atomic<size_t> files{0};
+    std::atomic<size_t> functions{0};
+    std::atomic<size_t> null_files{0};
+    std::atomic<size_t> prefiltered{0};
+    std::atomic<size_t> cached{0};
+    std::atomic<size_t> errors{0};
+};
+
+struct Counters {
+    explicit Counters(int workers) : per_worker(workers) {}
+
+    std::vector<WorkerCounters> per_worker;
+    // Set once enumeration finishes; 0 means "still counting".  Written by
+    // one thread, so sharing a line costs nothing.
+    std::atomic<size_t> total{0};
+
+    size_t sum(std::atomic<size_t> WorkerCounters::*member) const {
+        size_t s = 0;
+        for (const WorkerCounters &w : per_worker)
+            s += (w.*member).load(std::memory_order_relaxed);
+        return s;
+    }
+};
+
+// Samples the counters a few times a second from its own thread and redraws
+// one status line; the workers never block or write to the terminal.
+class ProgressDisplay {
+public:
+    explicit ProgressDisplay(const Counters &counters) : counters_(counters) {}
+
+    void start() { thread_ = std::thread(&ProgressDisplay::run, this); }
+
+    void stop() {
+        stop_.store(true);
+        if (thread_.joinable())
+            thread_.join();
+        if (drew_)
+            std::fprintf(stderr, "\n");
+    }
+
+private:
+    void run() {
+        auto last_time = std::chrono::steady_clock::now();
+        size_t last_files = 0;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            size_t files = counters_.sum(&WorkerCounters::files);
+            size_t funcs = counters_.sum(&WorkerCounters::functions);
+            size_t total = counters_.total.load(std::memory_order_relaxed);
+            auto now = std::chrono::steady_clock::now();
+            double dt = std::chrono::duration<double>(now - last_time).count();
+            double rate = dt > 0 ? (double)(files - last_files) / dt : 0;
+            last_time = now;
+            last_files = files;
+            if (total)
+                std::fprintf(stderr, "\rparsing... %zu/%zu files, %zu functions (%.0f files/s)  ",
+                             files, total, funcs, rate);
+            else
+                std::fprintf(stderr, "\rparsing... %zu files, %zu functions (%.0f files/s)  ",
+                             files, funcs, rate);
+            drew_ = true;
+        }
+    }
+
+    const Counters &counters_;
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    bool drew_ = false;
+};
+
+// Per-worker result sink: counters, the streaming shard writer, and (only
+// when binary output was requested) an in-memory copy for write_fc_bin.
+struct ResultSink {
+    WorkerCounters &counters;
+    ShardWriter &writer;
+    std::vector<FileResult> *keep = nullptr;
+    // --stats: this worker's column shard; null when stats are off.
+    StatsShard *stats = nullptr;
+};
+
+// Budget cost of a path sitting in the scheduler (for --mem-limit).
+size_t queue_cost(const std::string &path) {
+    return sizeof(WorkScheduler::Item) + path.size();
+}
+
+// Budget cost of one kept -o-bin result.
+size_t result_cost(const FileResult &r) {
+    return sizeof(FileResult) + r.path.size() +
+           r.functions.size() * sizeof(const char *);
+}
+
+void account(const FileResult &r, ResultSink &sink) {
+    WorkerCounters &counters = sink.counters;
+    if (r.cached)
+        counters.cached.fetch_add(1, std::memory_order_relaxed);
+    counters.files.fetch_add(1, std::memory_order_relaxed);
+    if (r.io_error)
+        counters.errors.fetch_add(1, std::memory_order_relaxed);
+    else if (r.functions.empty()) {
+        counters.null_files.fetch_add(1, std::memory_order_relaxed);
+        if (r.prefiltered)
+            counters.prefiltered.fetch_add(1, std::memory_order_relaxed);
+    }
+    counters.functions.fetch_add(r.functions.size(), std::memory_order_relaxed);
+    {
+        PhaseScope timed(Phase::Emit);
+        sink.writer.add(r);
+    }
+    if (sink.stats)
+        sink.stats->record(r);
+    if (sink.keep) {
+        governor().add(MemGovernor::Results, result_cost(r));
+        sink.keep->push_back(r);
+    }
+}
+
+// Batched-read worker: pops up to kReadBatch files, queues one IORING_OP_READ
+// per file, submits the lot with a single io_uring_enter, then parses as the
+// data arrives.  On a cold cache the kernel keeps the whole batch in flight
+// while we parse the previous one.
+constexpr unsigned kReadBatch = 16;
+
+// Cap on prefetched-but-unparsed bytes.  Generous enough that the workers
+// never catch the prefetch thread on a cold cache, small enough that what we
+// advise is still resident by the time its turn comes.
+constexpr size_t kPrefetchBudget = 256u << 20;
+
+struct PendingRead {
+    std::string path;
+    int fd = -1;
+    char *buf = nullptr;
+    size_t size = 0;
+    std::int64_t mtime_ns = -1;
+    bool handled = false;
+    // (size, mtime) cache hit: the file was never opened; the functions
+    // below are the whole result.
+    bool cached_hit = false;
+    std::vector<const char *> cached_functions;
+};
+
+void worker_main_uring(WorkScheduler &sched, int id, ResultSink &sink,
+                       ParseCache *cache, UringReader &ring,
+                       Prefetcher &prefetch) {
+    WorkScheduler::Item item;
+    std::vector<PendingRead> batch;
+    while (sched.pop(id, item)) {
+        batch.clear();
+        size_t batch_bytes = 0;
+        size_t queue_freed = 0;
+        do {
+            PendingRead p;
+            p.path = std::move(item.path);
+            batch_bytes += item.bytes;
+            queue_freed += queue_cost(p.path);
+            batch.push_back(std::move(p));
+        } while (batch.size() < kReadBatch && sched.try_pop(id, item));
+        governor().sub(MemGovernor::Queue, queue_freed);
+
+        {
+            PhaseScope timed(Phase::Read);
+            unsigned queued = 0;
+            for (size_t i = 0; i < batch.size(); ++i) {
+                PendingRead &p = batch[i];
+                struct stat st;
+                if (stat(p.path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+                    continue; // the fallback loop below reports the error
+                p.size = (size_t)st.st_size;
+                p.mtime_ns = stat_mtime_ns(st);
+                // A (size, mtime) hit skips the open and the read outright.
+                if (cache && cache->lookup_stat(p.path, (uint64_t)st.st_size,
+                                                p.mtime_ns,
+                                                p.cached_functions)) {
+                    p.cached_hit = true;
+                    continue;
+                }
+                p.fd = open(p.path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (p.fd < 0)
+                    continue;
+                p.buf = (char *)std::malloc(p.size ? p.size : 1);
+                if (!p.buf)
+                    continue;
+                if (ring.queue_read(p.fd, p.buf, (unsigned)p.size, i))
+                    ++queued;
+            }
+            if (queued)
+                ring.submit_and_wait(queued);
+        }
+
+        uint64_t idx;
+        int32_t res;
+        while (ring.next_completion(idx, res)) {
+            PendingRead &p = batch[idx];
+            if (res >= 0 && (size_t)res == p.size) {
+                account(analyze_buffer(p.path, p.buf, p.size, cache, p.mtime_ns),
+                        sink);
+                p.handled = true;
+            }
+            // Short or failed reads fall through to the slow path below
+            // rather than retrying ring bookkeeping for a case that
+            // basically never happens.
+        }
+        for (PendingRead &p : batch) {
+            if (p.cached_hit) {
+                FileResult r;
+                r.path = std::move(p.path);
+                r.functions = std::move(p.cached_functions);
+                r.bytes = p.size;
+                r.cached = true;
+                account(r, sink);
+            } else if (!p.handled) {
+                account(analyze_file(p.path, cache), sink);
+            }
+            std::free(p.buf);
+            if (p.fd >= 0)
+                close(p.fd);
+        }
+        prefetch.consumed(batch_bytes);
+    }
+}
+
+void worker_main(WorkScheduler &sched, int id, ResultSink sink,
+                 ParseCache *cache, Options::IoBackend backend,
+                 Prefetcher &prefetch) {
+    if (backend == Options::IoBackend::Uring) {
+        UringReader ring;
+        if (ring.init(kReadBatch)) {
+            worker_main_uring(sched, id, sink, cache, ring, prefetch);
+            return;
+        }
+        if (id == 0)
+            std::fprintf(stderr, "parsercfc: io_uring unavailable, using mmap\n");
+    }
+    WorkScheduler::Item item;
+    while (sched.pop(id, item)) {
+        governor().sub(MemGovernor::Queue, queue_cost(item.path));
+        account(analyze_file(item.path, cache), sink);
+        prefetch.consumed(item.bytes);
+    }
+}
+
+} // namespace
+
+RunResult run_scan(const Options &opt, ParseCache *warm_cache, bool show_progress) {
+    RunResult result;
+    auto start = std::chrono::steady_clock::now();
+    governor().set_limit(opt.mem_limit);
+
+    // --stream caps the queue: with ~8K in-flight paths the scheduler, the
+    // shard files and the counters are the only state that scales at all.
+    WorkScheduler sched(opt.workers, opt.stream ? 8192 : 0);
+    if (numa_node_count() > 1) {
+        std::vector<int> nodes(opt.workers);
+        for (int i = 0; i < opt.workers; ++i)
+            nodes[i] = numa_node_of_worker(i, opt.workers);
+        sched.set_nodes(std::move(nodes));
+    }
+    Counters counters(opt.workers);
+    // Shard mode suffixes everything this invocation writes, so n machines
+    // can drop their slices side by side for a later --merge.
+    std::string shard_sfx =
+        opt.shard_count ? "." + std::to_string(opt.shard_index) : "";
+
+    ParseCache local_cache;
+    ParseCache *cache_ptr = warm_cache;
+    std::string cache_path =
+        opt.cache_path.empty() ? opt.cache_path : opt.cache_path + shard_sfx;
+    if (!cache_ptr && !cache_path.empty()) {
+        local_cache.load(cache_path);
+        cache_ptr = &local_cache;
+    }
+
+    if (opt.zstd_level && !zstd_available()) {
+        result.summary = "--compress zstd requested but libzstd.so.1 could not be loaded";
+        return result;
+    }
+
+    std::vector<ShardWriter> writers(opt.workers);
+    for (int i = 0; i < opt.workers; ++i)
+        if (!writers[i].open(opt.output_fc + shard_sfx,
+                             opt.output_null_fc + shard_sfx, i, opt.zstd_level,
+                             opt.stream)) {
+            result.summary = "cannot create shard files";
+            return result;
+        }
+    // With -o-bin the workers also keep their results in memory (cheap:
+    // everything inside a FileResult is interned) for write_fc_bin below.
+    std::vector<std::vector<FileResult>> kept;
+    if (!opt.output_bin.empty())
+        kept.resize(opt.workers);
+    StatsCollector stats;
+    if (!opt.stats_path.empty())
+        stats.init(opt.workers);
+    // Readahead stage: a mirror of every scheduled file goes to a thread
+    // that fadvises ahead of the parse position, so on a cold cache the
+    // workers fault pages that are already in flight (see prefetch.h).
+    Prefetcher prefetch;
+    // Under --mem-limit the readahead window takes at most an eighth of the
+    // budget; prefetched pages are page cache, but advising far ahead of a
+    // throttled parse would just churn it.
+    size_t prefetch_budget = kPrefetchBudget;
+    if (opt.mem_limit)
+        prefetch_budget = std::min(prefetch_budget, opt.mem_limit / 8);
+    // The prefetch thread spends its life blocked in open/fadvise, so even
+    // with a worker on every core (-w $(nproc) on a cold cache -- the run
+    // this stage exists for) it costs little and overlaps I/O with parsing.
+    // Only a single-hardware-thread machine is excluded: there the kernel
+    // cannot run the readahead beside anything, and the stage is pure
+    // context-switch overhead.
+    if (std::thread::hardware_concurrency() > 1)
+        prefetch.start(prefetch_budget);
+    std::vector<std::thread> workers;
+    workers.reserve(opt.workers);
+    for (int i = 0; i < opt.workers; ++i) {
+        ResultSink sink{counters.per_worker[i], writers[i],
+                        kept.empty() ? nullptr : &kept[i],
+                        stats.enabled() ? &stats.shard(i) : nullptr};
+        workers.emplace_back([&, i, sink]() mutable {
+            // First-touch after the bind puts the arena, pool chunks and
+            // read buffers on this worker's node.
+            numa_bind_worker(i, opt.workers);
+            worker_main(sched, i, sink, cache_ptr, opt.io_backend, prefetch);
+        });
+    }
+
+    // No point redrawing a status line into a pipe -- and the display
+    // thread's sampling sleep would put a floor under short benchmark runs.
+    show_progress = show_progress && isatty(fileno(stderr));
+    ProgressDisplay display(counters);
+    if (show_progress)
+        display.start();
+
+    // Enumeration runs in parallel with parsing: walker threads feed the
+    // scheduler as they discover files.  Metadata traversal rarely profits
+    // past a few threads, so the walker pool is capped.
+    int walk_threads = std::min(opt.workers, 8);
+    PathFilter filter;
+    for (const std::string &p : opt.includes)
+        filter.add_include(p);
+    for (const std::string &p : opt.excludes)
+        filter.add_exclude(p);
+    // Offset of the dir-relative part of a walked path (for --shard).
+    size_t rel_off = opt.dir.size();
+    while (rel_off && opt.dir[rel_off - 1] == '/')
+        --rel_off;
+    ++rel_off;
+    std::atomic<size_t> total{0};
+    bool walk_ok;
+    {
+        PhaseScope timed(Phase::Enumerate);
+        walk_ok = ParallelWalker::walk(opt.dir, walk_threads,
+            [&](std::string path, size_t bytes) {
+                if (opt.shard_count &&
+                    !shard_selects(path.substr(rel_off), opt.shard_index,
+                                   opt.shard_count))
+                    return;
+                total.fetch_add(1, std::memory_order_relaxed);
+                // Under --mem-limit, stall enumeration here while the
+                // workers drain the queue back below the soft threshold.
+                governor().throttle();
+                governor().add(MemGovernor::Queue, queue_cost(path));
+                prefetch.add(path, bytes);
+                sched.push(std::move(path), bytes);
+            }, &filter);
+    }
+    counters.total.store(total.load(), std::memory_order_relaxed);
+    sched.close();
+
+    for (std::thread &t : workers)
+        t.join();
+    prefetch.stop();
+    if (show_progress)
+        display.stop();
+
+    // A root that would not open is a failed run, not an empty tree: the
+    // outputs still land (empty), but the exit status must tell a CI caller
+    // their path was wrong.
+    bool ok = walk_ok;
+    std::vector<std::string> fc_shards, null_shards;
+    for (ShardWriter &w : writers) {
+        ok = w.close() && ok;
+        fc_shards.push_back(w.fc_shard_path());
+        null_shards.push_back(w.null_shard_path());
+    }
+    {
+        PhaseScope timed(Phase::Emit);
+        if (opt.zstd_level) {
+            // Compressed shards are opaque frames; they are spliced in
+            // arrival order (see output.h).
+            ok = merge_shards(opt.output_fc + shard_sfx + ".zst", fc_shards,
+                              "{", "\n}\n", opt.zstd_level) && ok;
+            ok = merge_shards(opt.output_null_fc + shard_sfx + ".zst",
+                              null_shards, "[", "\n]\n", opt.zstd_level) && ok;
+        } else {
+            // Plain outputs come out path-sorted and deduplicated, so the
+            // files are byte-identical across -w values and runs.
+            std::vector<std::vector<EntryRec>> fc_recs, null_recs;
+            for (ShardWriter &w : writers) {
+                fc_recs.push_back(w.take_fc_records());
+                null_recs.push_back(w.take_null_records());
+            }
+            ok = merge_sorted(opt.output_fc + shard_sfx, fc_shards,
+                              std::move(fc_recs), "{", "\n}\n") && ok;
+            ok = merge_sorted(opt.output_null_fc + shard_sfx, null_shards,
+                              std::move(null_recs), "[", "\n]\n") && ok;
+        }
+    }
+    if (!opt.output_bin.empty()) {
+        std::vector<FileResult> all;
+        for (std::vector<FileResult> &k : kept)
+            all.insert(all.end(), std::make_move_iterator(k.begin()),
+                       std::make_move_iterator(k.end()));
+        ok = write_fc_bin(opt.output_bin, all) && ok;
+        for (const FileResult &r : all)
+            governor().sub(MemGovernor::Results, result_cost(r));
+    }
+    if (stats.enabled()) {
+        PhaseScope timed(Phase::Emit);
+        ok = stats.write(opt.stats_path) && ok;
+    }
+    if (cache_ptr == &local_cache && !local_cache.save(cache_path))
+        std::fprintf(stderr, "parsercfc: warning: could not update cache %s\n",
+                     cache_path.c_str());
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start).count();
+
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+                  "parsed %zu files (%zu functions, %zu with no definition "
+                  "of which %zu pre-filtered, %zu from cache, %zu unreadable) "
+                  "in %lld.%03llds with %d workers",
+                  counters.sum(&WorkerCounters::files),
+                  counters.sum(&WorkerCounters::functions),
+                  counters.sum(&WorkerCounters::null_files),
+                  counters.sum(&WorkerCounters::prefiltered),
+                  counters.sum(&WorkerCounters::cached),
+                  counters.sum(&WorkerCounters::errors),
+                  (long long)(elapsed / 1000), (long long)(elapsed % 1000),
+                  opt.workers);
+    result.summary = buf;
+    result.ok = ok;
+    return result;
+}
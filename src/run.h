@@ -0,0 +1,25 @@
+#ifndef PARSERCFC_RUN_H
+#define PARSERCFC_RUN_H
+
+#include <string>
+
+#include "options.h"
+
+class ParseCache;
+
+// Outcome of one full scan: whether outputs were written successfully and
+// the human-readable summary line (also what the daemon sends back).
+struct RunResult {
+    bool ok = false;
+    std::string summary;
+};
+
+// Runs the complete pipeline (enumerate, schedule, parse, merge shards) for
+// `opt`.  When `warm_cache` is non-null it is used as-is and not saved --
+// that is the daemon's long-lived cache; otherwise opt.cache_path (if set)
+// is loaded and saved locally.  `show_progress` controls the sampling
+// display thread.
+RunResult run_scan(const Options &opt, ParseCache *warm_cache = nullptr,
+                   bool show_progress = true);
+
+#endif
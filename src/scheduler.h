@@ -0,0 +1,181 @@
+#ifndef PARSERCFC_SCHEDULER_H
+#define PARSERCFC_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Work-stealing scheduler that balances by file *bytes*, not file count.
+// A tree mixes four-line stubs with megabyte generated tables; with a plain
+// FIFO one worker can end up owning most of the heavy files.  Here the
+// producer routes each file to the worker currently holding the fewest
+// assigned-but-unparsed bytes, and a worker that drains its own deque steals
+// from the back of the byte-richest victim.
+class WorkScheduler {
+public:
+    struct Item {
+        std::string path;
+        std::size_t bytes = 0;
+    };
+
+    // max_items > 0 bounds the total queued item count: push() then blocks
+    // the producer until a consumer makes room, which is what keeps memory
+    // flat in --stream mode no matter how fast enumeration outruns parsing.
+    explicit WorkScheduler(int workers, std::size_t max_items = 0)
+        : queues_(workers), max_items_(max_items) {}
+
+    // Optional NUMA partitioning: nodes[i] is worker i's node.  When set,
+    // steal() raids same-node victims first and crosses nodes only once the
+    // whole local node has run dry.
+    void set_nodes(std::vector<int> nodes) { nodes_ = std::move(nodes); }
+
+    // Producer side: route to the least-loaded worker by pending bytes.
+    void push(std::string path, std::size_t bytes) {
+        if (max_items_) {
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            space_cv_.wait(lock, [this] {
+                return pending_items_.load() < max_items_;
+            });
+        }
+        int target = 0;
+        std::size_t best = SIZE_MAX;
+        for (int i = 0; i < (int)queues_.size(); ++i) {
+            std::size_t load = queues_[i].pending_bytes.load(std::memory_order_relaxed);
+            if (load < best) {
+                best = load;
+                target = i;
+            }
+        }
+        PerWorker &q = queues_[target];
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.items.push_back(Item{std::move(path), bytes});
+        }
+        q.pending_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        pending_items_.fetch_add(1);
+        // Taking the sleep mutex (even empty) pairs with the wait predicate
+        // so a worker can never check, miss this item, and then block.
+        { std::lock_guard<std::mutex> g(sleep_mutex_); }
+        cv_.notify_all();
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    // Non-blocking pop (own deque, then steal).  Used to top up a read
+    // batch without sleeping for stragglers.
+    bool try_pop(int self, Item &out) {
+        return take_front(queues_[self], out) || steal(self, out);
+    }
+
+    // Consumer side.  Returns false only when the producer is done and every
+    // deque (own and victims') is empty.
+    bool pop(int self, Item &out) {
+        for (;;) {
+            if (take_front(queues_[self], out) || steal(self, out))
+                return true;
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            if (pending_items_.load() == 0 && closed_)
+                return false;
+            cv_.wait(lock, [this] {
+                return pending_items_.load() > 0 || closed_;
+            });
+        }
+    }
+
+private:
+    struct alignas(64) PerWorker {
+        std::mutex mutex;
+        std::deque<Item> items;
+        std::atomic<std::size_t> pending_bytes{0};
+    };
+
+    bool take_front(PerWorker &q, Item &out) {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.items.empty())
+            return false;
+        out = std::move(q.items.front());
+        q.items.pop_front();
+        q.pending_bytes.fetch_sub(out.bytes, std::memory_order_relaxed);
+        pending_items_.fetch_sub(1);
+        notify_space();
+        return true;
+    }
+
+    bool take_back(PerWorker &q, Item &out) {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.items.empty())
+            return false;
+        out = std::move(q.items.back());
+        q.items.pop_back();
+        q.pending_bytes.fetch_sub(out.bytes, std::memory_order_relaxed);
+        pending_items_.fetch_sub(1);
+        notify_space();
+        return true;
+    }
+
+    bool same_node(int a, int b) const {
+        return nodes_.empty() || nodes_[a] == nodes_[b];
+    }
+
+    // Steal from the byte-richest victim; fall through the rest on a miss.
+    // With a node map set, both passes run over same-node victims first so
+    // work only crosses the interconnect as a last resort.
+    bool steal_from(int self, Item &out, bool local) {
+        int victim = -1;
+        std::size_t best = 0;
+        for (int i = 0; i < (int)queues_.size(); ++i) {
+            if (i == self || same_node(self, i) != local)
+                continue;
+            std::size_t load = queues_[i].pending_bytes.load(std::memory_order_relaxed);
+            if (load > best) {
+                best = load;
+                victim = i;
+            }
+        }
+        if (victim >= 0 && take_back(queues_[victim], out))
+            return true;
+        for (int i = 0; i < (int)queues_.size(); ++i)
+            if (i != self && same_node(self, i) == local &&
+                take_back(queues_[i], out))
+                return true;
+        return false;
+    }
+
+    bool steal(int self, Item &out) {
+        if (steal_from(self, out, true))
+            return true;
+        return !nodes_.empty() && steal_from(self, out, false);
+    }
+
+    // Same handshake as push()'s wakeup: touching sleep_mutex_ pairs with
+    // the producer's wait predicate so the decrement cannot be missed.
+    void notify_space() {
+        if (!max_items_)
+            return;
+        { std::lock_guard<std::mutex> g(sleep_mutex_); }
+        space_cv_.notify_one();
+    }
+
+    std::vector<PerWorker> queues_;
+    std::vector<int> nodes_;
+    std::size_t max_items_;
+    std::atomic<std::size_t> pending_items_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable cv_;
+    std::condition_variable space_cv_;
+    bool closed_ = false;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "shard.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <vector>
+
+#include "cache.h"
+
+bool shard_selects(const std::string &rel, int index, int count) {
+    return (int)(ParseCache::hash_bytes(rel.data(), rel.size()) % count) == index;
+}
+
+namespace {
+
+// Collects <base>.0, <base>.1, ... for as long as they exist.
+std::vector<std::string> shard_files(const std::string &base) {
+    std::vector<std::string> files;
+    for (int i = 0;; ++i) {
+        std::string path = base + "." + std::to_string(i);
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+            break;
+        files.push_back(std::move(path));
+    }
+    return files;
+}
+
+// Stitches complete shard documents back into one: each shard is a full
+// fc.json/null_fc.json as this tool writes them, so the merge strips the
+// one-byte head and the "\n}\n"/"\n]\n" tail and joins the middles.
+bool merge_documents(const std::string &out_path, const char *head, const char *tail) {
+    std::vector<std::string> shards = shard_files(out_path);
+    if (shards.empty()) {
+        std::fprintf(stderr, "parsercfc: no shard files %s.0 ... to merge\n",
+                     out_path.c_str());
+        return false;
+    }
+    std::string tmp = out_path + ".tmp";
+    std::ofstream out(tmp, std::ios::binary);
+    if (!out) {
+        std::fprintf(stderr, "parsercfc: cannot write %s\n", out_path.c_str());
+        return false;
+    }
+    out << head;
+    bool first = true;
+    std::size_t tail_len = std::string(tail).size();
+    for (const std::string &shard : shards) {
+        std::ifstream in(shard, std::ios::binary);
+        std::ostringstream buf;
+        buf << in.rdbuf();
+        std::string doc = buf.str();
+        if (doc.size() < 1 + tail_len || doc[0] != head[0] ||
+            doc.compare(doc.size() - tail_len, tail_len, tail) != 0) {
+            std::fprintf(stderr, "parsercfc: %s does not look like a shard output\n",
+                         shard.c_str());
+            return false;
+        }
+        std::string middle = doc.substr(1, doc.size() - 1 - tail_len);
+        if (middle.empty())
+            continue;
+        if (!first)
+            out << ",";
+        first = false;
+        out << middle;
+    }
+    out << tail;
+    out.close();
+    if (!out || std::rename(tmp.c_str(), out_path.c_str()) != 0) {
+        std::fprintf(stderr, "parsercfc: cannot write %s\n", out_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int run_merge(const Options &opt) {
+    bool ok = merge_documents(opt.output_fc, "{", "\n}\n");
+    ok = merge_documents(opt.output_null_fc, "[", "\n]\n") && ok;
+    if (!opt.cache_path.empty()) {
+        // The caches are keyed by content hash, so the union is just loading
+        // every shard's file into one cache and writing it back.
+        ParseCache cache;
+        for (const std::string &shard : shard_files(opt.cache_path))
+            cache.load(shard);
+        if (!cache.save(opt.cache_path)) {
+            std::fprintf(stderr, "parsercfc: cannot write %s\n", opt.cache_path.c_str());
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+#ifndef PARSERCFC_SHARD_H
+#define PARSERCFC_SHARD_H
+
+#include <string>
+
+#include "options.h"
+
+// Farm sharding (--shard i/n): n invocations on different machines each take
+// a deterministic slice of the file set and write fc.json.i / null_fc.json.i
+// (and cache.i with --cache); --merge later combines the slices into the
+// canonical files.  The partition is a stable hash of the dir-relative path,
+// so the same file lands on the same machine every night and that machine's
+// content cache stays hot.
+
+// True when the file with this dir-relative path belongs to shard `index`.
+bool shard_selects(const std::string &rel, int index, int count);
+
+// Implements --merge: stitches <output>.0 .. <output>.n-1 into <output> for
+// both JSON outputs, and unions the per-shard caches when --cache is given.
+int run_merge(const Options &opt);
+
+#endif
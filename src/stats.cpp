@@ -0,0 +1,163 @@
+#include "stats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <numeric>
+
+#include "output.h"
+
+namespace {
+
+constexpr std::size_t kTopFiles = 10;
+
+// functions-per-file buckets: exact up to 4, then doubling.
+const char *const kFuncBuckets[] = {"0", "1", "2", "3", "4",
+                                    "5-8", "9-16", "17-32", "33+"};
+
+std::size_t func_bucket(std::uint32_t n) {
+    if (n <= 4)
+        return n;
+    if (n <= 8)
+        return 5;
+    if (n <= 16)
+        return 6;
+    if (n <= 32)
+        return 7;
+    return 8;
+}
+
+// Directory part of `path` ("." for a bare filename).
+std::string_view dir_of(const std::string &path) {
+    std::size_t slash = path.rfind('/');
+    return slash == std::string::npos ? std::string_view(".")
+                                      : std::string_view(path).substr(0, slash);
+}
+
+double percentile(std::vector<double> &sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    std::size_t i = (std::size_t)(p * (double)(sorted.size() - 1));
+    return sorted[i];
+}
+
+} // namespace
+
+bool StatsCollector::write(const std::string &out_path) {
+    // Flatten the shards into one set of columns.  Row order is scheduling
+    // order, which no reduction below depends on.
+    std::size_t rows = 0;
+    for (const StatsShard &s : shards_)
+        rows += s.path.size();
+    std::vector<const std::string *> path;
+    std::vector<std::uint64_t> bytes;
+    std::vector<std::uint32_t> funcs;
+    path.reserve(rows);
+    bytes.reserve(rows);
+    funcs.reserve(rows);
+    for (const StatsShard &s : shards_) {
+        for (const std::string &p : s.path)
+            path.push_back(&p);
+        bytes.insert(bytes.end(), s.bytes.begin(), s.bytes.end());
+        funcs.insert(funcs.end(), s.funcs.begin(), s.funcs.end());
+    }
+
+    // Straight-line column reductions; these are the loops the columnar
+    // layout exists for.
+    std::uint64_t total_bytes =
+        std::accumulate(bytes.begin(), bytes.end(), std::uint64_t(0));
+    std::uint64_t total_funcs =
+        std::accumulate(funcs.begin(), funcs.end(), std::uint64_t(0));
+    std::size_t null_files = 0;
+    std::uint64_t hist[sizeof(kFuncBuckets) / sizeof(*kFuncBuckets)] = {};
+    for (std::uint32_t n : funcs) {
+        ++hist[func_bucket(n)];
+        if (n == 0)
+            ++null_files;
+    }
+
+    std::vector<double> per_func;
+    for (std::size_t i = 0; i < rows; ++i)
+        if (funcs[i])
+            per_func.push_back((double)bytes[i] / funcs[i]);
+    std::sort(per_func.begin(), per_func.end());
+    double mean_per_func = per_func.empty()
+        ? 0
+        : std::accumulate(per_func.begin(), per_func.end(), 0.0) /
+              (double)per_func.size();
+
+    std::vector<std::size_t> by_size(rows);
+    std::iota(by_size.begin(), by_size.end(), 0);
+    std::size_t top = std::min(kTopFiles, rows);
+    std::partial_sort(by_size.begin(), by_size.begin() + top, by_size.end(),
+                      [&](std::size_t a, std::size_t b) {
+                          return bytes[a] > bytes[b];
+                      });
+
+    struct DirRoll {
+        std::uint64_t files = 0, functions = 0, bytes = 0;
+    };
+    std::map<std::string_view, DirRoll> dirs;
+    for (std::size_t i = 0; i < rows; ++i) {
+        DirRoll &d = dirs[dir_of(*path[i])];
+        ++d.files;
+        d.functions += funcs[i];
+        d.bytes += bytes[i];
+    }
+
+    std::FILE *out = std::fopen(out_path.c_str(), "wb");
+    if (!out) {
+        std::fprintf(stderr, "parsercfc: cannot write %s\n", out_path.c_str());
+        return false;
+    }
+    std::fprintf(out,
+                 "{\n"
+                 "  \"files\": %zu,\n"
+                 "  \"functions\": %llu,\n"
+                 "  \"bytes\": %llu,\n"
+                 "  \"null_files\": %zu,\n",
+                 rows, (unsigned long long)total_funcs,
+                 (unsigned long long)total_bytes, null_files);
+
+    std::fprintf(out, "  \"functions_per_file\": {");
+    for (std::size_t i = 0; i < sizeof(kFuncBuckets) / sizeof(*kFuncBuckets); ++i)
+        std::fprintf(out, "%s\"%s\": %llu", i ? ", " : "", kFuncBuckets[i],
+                     (unsigned long long)hist[i]);
+    std::fprintf(out, "},\n");
+
+    std::fprintf(out,
+                 "  \"bytes_per_function\": {\"mean\": %.1f, \"p50\": %.1f, "
+                 "\"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f},\n",
+                 mean_per_func, percentile(per_func, 0.50),
+                 percentile(per_func, 0.90), percentile(per_func, 0.99),
+                 per_func.empty() ? 0 : per_func.back());
+
+    std::fprintf(out, "  \"largest_files\": [");
+    for (std::size_t i = 0; i < top; ++i) {
+        std::size_t row = by_size[i];
+        std::string key;
+        append_json_string(key, *path[row]);
+        std::fprintf(out,
+                     "%s\n    {\"path\": %s, \"bytes\": %llu, \"functions\": %u}",
+                     i ? "," : "", key.c_str(), (unsigned long long)bytes[row],
+                     funcs[row]);
+    }
+    std::fprintf(out, "\n  ],\n");
+
+    std::fprintf(out, "  \"directories\": {");
+    bool first = true;
+    for (const auto &[dir, roll] : dirs) {
+        std::string key;
+        append_json_string(key, dir);
+        std::fprintf(out,
+                     "%s\n    %s: {\"files\": %llu, \"functions\": %llu, "
+                     "\"bytes\": %llu}",
+                     first ? "" : ",", key.c_str(),
+                     (unsigned long long)roll.files,
+                     (unsigned long long)roll.functions,
+                     (unsigned long long)roll.bytes);
+        first = false;
+    }
+    std::fprintf(out, "\n  }\n}\n");
+    return std::fclose(out) == 0;
+}
@@ -0,0 +1,45 @@
+#ifndef PARSERCFC_STATS_H
+#define PARSERCFC_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "analyze.h"
+
+// Columnar per-file statistics behind --stats.  Each worker appends to its
+// own shard of parallel arrays (path, byte size, function count -- the
+// file id is the row index), so collection is an unsynchronized push_back
+// per file on the hot path.  All analytics are computed at run end as
+// plain reductions over the columns, which the compiler vectorizes: the
+// whole thing rides along with the parse pass instead of a second tool
+// re-reading gigabytes of fc.json.
+struct StatsShard {
+    std::vector<std::string> path;
+    std::vector<std::uint64_t> bytes;
+    std::vector<std::uint32_t> funcs;
+
+    void record(const FileResult &r) {
+        path.push_back(r.path);
+        bytes.push_back(r.bytes);
+        funcs.push_back((std::uint32_t)r.functions.size());
+    }
+};
+
+class StatsCollector {
+public:
+    void init(int workers) { shards_.resize(workers); }
+    bool enabled() const { return !shards_.empty(); }
+    StatsShard &shard(int worker) { return shards_[worker]; }
+
+    // Aggregates every shard and writes stats.json: totals, a
+    // functions-per-file histogram, the bytes-per-function distribution,
+    // the largest files and per-directory rollups.
+    bool write(const std::string &out_path);
+
+private:
+    std::vector<StatsShard> shards_;
+};
+
+#endif
@@ -0,0 +1,6 @@
+#include "strpool.h"
+
+StringPool &string_pool() {
+    static StringPool pool;
+    return pool;
+}
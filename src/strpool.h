@@ -0,0 +1,47 @@
+#ifndef PARSERCFC_STRPOOL_H
+#define PARSERCFC_STRPOOL_H
+
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+
+#include "arena.h"
+
+// Process-wide string interning.  Function names repeat massively across a
+// tree ("init", "probe", the same static helpers in thousands of drivers):
+// interning stores each distinct spelling once and turns every later use --
+// results, cache entries, output, statistics -- into pointer traffic.
+// Pointers returned by intern() are stable for the life of the process.
+//
+// The table is sharded by hash so workers interning concurrently rarely
+// touch the same lock; each shard owns an arena for the bytes.
+class StringPool {
+public:
+    static constexpr unsigned kShards = 16;
+
+    const char *intern(std::string_view s) {
+        std::size_t h = std::hash<std::string_view>{}(s);
+        Shard &shard = shards_[h & (kShards - 1)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.strings.find(s);
+        if (it != shard.strings.end())
+            return it->data();
+        const char *copy = shard.arena.copy(s.data(), s.size());
+        shard.strings.emplace(copy, s.size());
+        return copy;
+    }
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_set<std::string_view> strings;
+        Arena arena;
+    };
+    Shard shards_[kShards];
+};
+
+// The one pool.  Results, the cache and the daemon all hold interned
+// pointers across scan boundaries, so the pool's lifetime is the process.
+StringPool &string_pool();
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef PARSERCFC_URING_H
+#define PARSERCFC_URING_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Minimal io_uring wrapper for the batched read pipeline.  Driven straight
+// through the raw syscalls and <linux/io_uring.h> (no liburing dependency):
+// parsercfc only ever needs "submit N whole-file reads, wait for them all",
+// so the few dozen lines of ring bookkeeping are cheaper than a library.
+//
+// On a cold page cache this turns QD openat+read round trips per worker into
+// one io_uring_enter, and lets the kernel keep QD reads in flight per worker
+// while the previous batch parses.  init() returns false where io_uring is
+// unavailable (old kernel, seccomp); callers fall back to the mmap path.
+class UringReader {
+public:
+    UringReader() = default;
+    ~UringReader();
+    UringReader(const UringReader &) = delete;
+    UringReader &operator=(const UringReader &) = delete;
+
+    bool init(unsigned entries);
+    bool available() const { return ring_fd_ >= 0; }
+
+    // Queues a read of `len` bytes at offset 0 into `buf`.  Returns false if
+    // the submission queue is full (flush with submit_and_wait first).
+    bool queue_read(int fd, void *buf, unsigned len, uint64_t user_data);
+
+    // Submits everything queued and blocks until `wait_for` completions are
+    // reachable.  Returns number submitted, or -1 on error.
+    int submit_and_wait(unsigned wait_for);
+
+    // Pops one completion; false when the completion queue is drained.
+    bool next_completion(uint64_t &user_data, int32_t &result);
+
+private:
+    int ring_fd_ = -1;
+    unsigned sq_entries_ = 0;
+    unsigned to_submit_ = 0;
+
+    // Submission side.
+    void *sq_ring_ = nullptr;
+    std::size_t sq_ring_size_ = 0;
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_mask_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    void *sqes_ = nullptr;
+    std::size_t sqes_size_ = 0;
+
+    // Completion side.
+    void *cq_ring_ = nullptr;
+    std::size_t cq_ring_size_ = 0;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned *cq_mask_ = nullptr;
+    void *cqes_ = nullptr;
+};
+
+#endif
@@ -0,0 +1,152 @@
+#include "walker.h"
+
+#include "filter.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <dirent.h>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct WalkState {
+    std::deque<std::string> dirs;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int active = 0;                 // directories currently being scanned
+    const PathFilter *filter = nullptr;
+    std::size_t root_len = 0;       // strip to get the filter-relative path
+};
+
+// Root-relative view of `path`, NUL-terminated (it is a suffix).
+const char *relative(const std::string &path, const WalkState &state) {
+    std::size_t off = state.root_len;
+    if (off < path.size() && path[off] == '/')
+        ++off;
+    return path.c_str() + off;
+}
+
+bool has_c_extension(const char *name) {
+    std::size_t len = std::strlen(name);
+    return len > 2 && name[len - 2] == '.' && name[len - 1] == 'c';
+}
+
+void scan_dir(const std::string &dir, WalkState &state, const ParallelWalker::Sink &sink) {
+    DIR *d = opendir(dir.c_str());
+    if (!d) {
+        std::fprintf(stderr, "parsercfc: warning: skipping unreadable directory %s\n",
+                     dir.c_str());
+        return;
+    }
+    std::vector<std::string> subdirs;
+    while (struct dirent *ent = readdir(d)) {
+        if (ent->d_name[0] == '.' &&
+            (ent->d_name[1] == '\0' || (ent->d_name[1] == '.' && ent->d_name[2] == '\0')))
+            continue;
+        std::string path = dir;
+        if (path.empty() || path.back() != '/')
+            path += '/';
+        path += ent->d_name;
+
+        unsigned char type = ent->d_type;
+        struct stat st;
+        bool have_stat = false;
+        if (type == DT_UNKNOWN || type == DT_LNK) {
+            // Filesystems without d_type, or symlinks: one stat decides.
+            // stat() follows links, so a link to a regular .c file counts
+            // but a link to a directory is not descended into (lstat'd
+            // below keeps d_type semantics for dirs).
+            if (type == DT_LNK) {
+                if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+                    type = DT_REG;
+                    have_stat = true;
+                } else {
+                    continue;
+                }
+            } else if (lstat(path.c_str(), &st) == 0) {
+                type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISREG(st.st_mode) ? DT_REG : 0;
+                have_stat = true;
+            } else {
+                continue;
+            }
+        }
+
+        if (type == DT_DIR) {
+            if (state.filter && !state.filter->descend(relative(path, state)))
+                continue;
+            subdirs.push_back(std::move(path));
+        } else if (type == DT_REG && has_c_extension(ent->d_name)) {
+            if (state.filter && !state.filter->allows(relative(path, state)))
+                continue;
+            if (!have_stat && stat(path.c_str(), &st) != 0)
+                st.st_size = 0;
+            sink(std::move(path), (std::size_t)st.st_size);
+        }
+    }
+    closedir(d);
+
+    if (!subdirs.empty()) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (std::string &s : subdirs)
+            state.dirs.push_back(std::move(s));
+    }
+    state.cv.notify_all();
+}
+
+void walker_thread(WalkState &state, const ParallelWalker::Sink &sink) {
+    std::unique_lock<std::mutex> lock(state.mutex);
+    for (;;) {
+        state.cv.wait(lock, [&state] {
+            return !state.dirs.empty() || state.active == 0;
+        });
+        if (state.dirs.empty()) {
+            if (state.active == 0)
+                return;
+            continue;
+        }
+        std::string dir = std::move(state.dirs.front());
+        state.dirs.pop_front();
+        ++state.active;
+        lock.unlock();
+        scan_dir(dir, state, sink);
+        lock.lock();
+        --state.active;
+        if (state.active == 0 && state.dirs.empty())
+            state.cv.notify_all();
+    }
+}
+
+} // namespace
+
+bool ParallelWalker::walk(const std::string &root, int threads, const Sink &sink,
+                          const PathFilter *filter) {
+    // opendir, not stat: a root that exists but cannot be read (EACCES)
+    // must fail the run too, not masquerade as an empty tree.
+    DIR *d = opendir(root.c_str());
+    if (!d) {
+        std::fprintf(stderr, "parsercfc: cannot open directory %s\n", root.c_str());
+        return false;
+    }
+    closedir(d);
+    WalkState state;
+    state.filter = filter && !filter->empty() ? filter : nullptr;
+    state.root_len = root.size();
+    while (state.root_len && root[state.root_len - 1] == '/')
+        --state.root_len;
+    state.dirs.push_back(root);
+    if (threads < 1)
+        threads = 1;
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (int i = 0; i < threads; ++i)
+        pool.emplace_back(walker_thread, std::ref(state), std::cref(sink));
+    for (std::thread &t : pool)
+        t.join();
+    return true;
+}
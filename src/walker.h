@@ -0,0 +1,31 @@
+#ifndef PARSERCFC_WALKER_H
+#define PARSERCFC_WALKER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// Parallel directory enumeration.  Big trees keep millions of directory
+// inodes; walking them on one thread leaves the worker pool starved at the
+// start of every run.  walk() fans the traversal out over `threads` threads
+// that share a deque of unvisited directories, calling `sink` for every
+// regular .c file found (with its size, for the byte-balanced scheduler).
+// The sink must be thread-safe; WorkScheduler::push is.  Returns false when
+// `root` cannot be opened as a directory at all -- callers must fail the
+// run rather than mistake a typo'd path for an empty tree.  Unreadable
+// subdirectories further down are skipped with a warning as before.
+// Directory symlinks are not followed.
+//
+// A non-null `filter` is consulted with root-relative paths: excluded
+// directories are pruned before descending, non-matching files are skipped.
+class PathFilter;
+
+class ParallelWalker {
+public:
+    using Sink = std::function<void(std::string path, std::size_t bytes)>;
+
+    static bool walk(const std::string &root, int threads, const Sink &sink,
+                     const PathFilter *filter = nullptr);
+};
+
+#endif
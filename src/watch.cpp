@@ -0,0 +1,228 @@
+#include "watch.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <dirent.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "analyze.h"
+#include "cache.h"
+#include "filter.h"
+#include "output.h"
+#include "scheduler.h"
+#include "walker.h"
+
+namespace {
+
+// The whole result set, path -> defined functions.  std::map so the outputs
+// come out path-sorted, which keeps successive rewrites diffable.
+using ResultMap = std::map<std::string, std::vector<const char *>>;
+
+bool has_c_suffix(const char *name) {
+    std::size_t n = std::strlen(name);
+    return n > 2 && name[n - 2] == '.' && name[n - 1] == 'c';
+}
+
+// Rewrites both outputs from the in-memory set, atomically (.tmp + rename).
+bool write_outputs(const Options &opt, const ResultMap &results) {
+    struct Out { const std::string &path; const char *head, *tail; bool null_only; };
+    for (const Out &o : {Out{opt.output_fc, "{", "\n}\n", false},
+                         Out{opt.output_null_fc, "[", "\n]\n", true}}) {
+        std::string tmp = o.path + ".tmp";
+        std::FILE *f = std::fopen(tmp.c_str(), "wb");
+        if (!f) {
+            std::fprintf(stderr, "parsercfc: cannot write %s\n", o.path.c_str());
+            return false;
+        }
+        std::string text = o.head;
+        bool first = true;
+        for (const auto &r : results) {
+            if (o.null_only && !r.second.empty())
+                continue;
+            text += first ? "\n    " : ",\n    ";
+            first = false;
+            append_json_string(text, r.first);
+            if (!o.null_only) {
+                text += ": {\"fc\": [";
+                for (std::size_t i = 0; i < r.second.size(); ++i) {
+                    if (i)
+                        text += ", ";
+                    append_json_string(text, r.second[i]);
+                }
+                text += "]}";
+            }
+            if (text.size() >= (1u << 20)) {
+                std::fwrite(text.data(), 1, text.size(), f);
+                text.clear();
+            }
+        }
+        text += o.tail;
+        std::fwrite(text.data(), 1, text.size(), f);
+        bool ok = std::fclose(f) == 0 && std::rename(tmp.c_str(), o.path.c_str()) == 0;
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+// Adds watches on `dir` and every subdirectory, filling wd -> path.  Also
+// the hook for directories that appear while watching.  Excluded
+// directories are neither watched nor descended into, mirroring the
+// walker's pruning.
+void watch_tree(int infd, const std::string &dir,
+                std::unordered_map<int, std::string> &dirs,
+                const PathFilter &filter, std::size_t rel_off) {
+    int wd = inotify_add_watch(infd, dir.c_str(),
+                               IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                               IN_MOVED_TO | IN_MOVED_FROM);
+    if (wd < 0)
+        return;
+    dirs[wd] = dir;
+    DIR *d = opendir(dir.c_str());
+    if (!d)
+        return;
+    while (struct dirent *e = readdir(d)) {
+        if (e->d_name[0] == '.' &&
+            (e->d_name[1] == '\0' || (e->d_name[1] == '.' && e->d_name[2] == '\0')))
+            continue;
+        if (e->d_type == DT_DIR) {
+            std::string sub = dir + "/" + e->d_name;
+            if (filter.empty() || filter.descend(sub.c_str() + rel_off))
+                watch_tree(infd, sub, dirs, filter, rel_off);
+        }
+    }
+    closedir(d);
+}
+
+void apply(ResultMap &results, FileResult r) {
+    if (r.io_error)
+        results.erase(r.path);
+    else
+        results[std::move(r.path)] = std::move(r.functions);
+}
+
+} // namespace
+
+int run_watch(const Options &opt) {
+    ParseCache cache;
+    ParseCache *cache_ptr = nullptr;
+    if (!opt.cache_path.empty()) {
+        cache.load(opt.cache_path);
+        cache_ptr = &cache;
+    }
+
+    PathFilter filter;
+    for (const std::string &p : opt.includes)
+        filter.add_include(p);
+    for (const std::string &p : opt.excludes)
+        filter.add_exclude(p);
+    // Offset of the dir-relative part of paths under opt.dir (for filtering).
+    std::size_t rel_off = opt.dir.size();
+    while (rel_off && opt.dir[rel_off - 1] == '/')
+        --rel_off;
+    ++rel_off;
+
+    // Watches go up before the initial pass so edits that land during it are
+    // seen as events rather than lost in the gap.
+    int infd = inotify_init1(IN_CLOEXEC);
+    if (infd < 0) {
+        std::perror("parsercfc: inotify_init1");
+        return 1;
+    }
+    std::unordered_map<int, std::string> dirs;
+    watch_tree(infd, opt.dir, dirs, filter, rel_off);
+    if (dirs.empty()) {
+        std::fprintf(stderr, "parsercfc: cannot watch %s\n", opt.dir.c_str());
+        return 1;
+    }
+
+    // Initial full pass: same walker + byte-balanced scheduler as a one-shot
+    // run, but results land in the in-memory map instead of shard files.
+    ResultMap results;
+    {
+        WorkScheduler sched(opt.workers);
+        std::mutex results_mutex;
+        std::vector<std::thread> workers;
+        for (int i = 0; i < opt.workers; ++i)
+            workers.emplace_back([&, i] {
+                WorkScheduler::Item item;
+                while (sched.pop(i, item)) {
+                    FileResult r = analyze_file(item.path, cache_ptr);
+                    std::lock_guard<std::mutex> lock(results_mutex);
+                    apply(results, std::move(r));
+                }
+            });
+        ParallelWalker::walk(opt.dir, std::min(opt.workers, 8),
+            [&sched](std::string path, std::size_t bytes) {
+                sched.push(std::move(path), bytes);
+            }, &filter);
+        sched.close();
+        for (std::thread &t : workers)
+            t.join();
+    }
+    if (!write_outputs(opt, results))
+        return 1;
+    std::fprintf(stderr, "parsercfc: watching %s (%zu files)\n",
+                 opt.dir.c_str(), results.size());
+
+    char buf[16 * 1024];
+    for (;;) {
+        ssize_t n = read(infd, buf, sizeof(buf));
+        if (n <= 0)
+            break;
+        std::size_t updated = 0;
+        for (;;) {
+            for (char *p = buf; p < buf + n;) {
+                auto *ev = (struct inotify_event *)p;
+                p += sizeof(*ev) + ev->len;
+                auto it = dirs.find(ev->wd);
+                if (it == dirs.end() || !ev->len)
+                    continue;
+                std::string path = it->second + "/" + ev->name;
+                if (ev->mask & IN_ISDIR) {
+                    if ((ev->mask & (IN_CREATE | IN_MOVED_TO)) &&
+                        (filter.empty() ||
+                         filter.descend(path.c_str() + rel_off)))
+                        watch_tree(infd, path, dirs, filter, rel_off);
+                    continue;
+                }
+                if (!has_c_suffix(ev->name))
+                    continue;
+                if (!filter.empty() && !filter.allows(path.c_str() + rel_off))
+                    continue;
+                if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    updated += results.erase(path);
+                } else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    apply(results, analyze_file(path, cache_ptr));
+                    ++updated;
+                }
+            }
+            // Quiet period: soak up the rest of a save burst (editors touch
+            // several files at once) before paying for one rewrite.
+            struct pollfd pfd{infd, POLLIN, 0};
+            if (poll(&pfd, 1, 200) <= 0)
+                break;
+            n = read(infd, buf, sizeof(buf));
+            if (n <= 0)
+                break;
+        }
+        if (updated) {
+            write_outputs(opt, results);
+            if (cache_ptr)
+                cache.save(opt.cache_path);
+            std::fprintf(stderr, "parsercfc: %zu file(s) re-parsed, outputs updated\n",
+                         updated);
+        }
+    }
+    close(infd);
+    return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef PARSERCFC_WATCH_H
+#define PARSERCFC_WATCH_H
+
+#include "options.h"
+
+// Watch mode (--watch): one full parallel pass to build the result set in
+// memory, then inotify watches across the tree re-parse only the files that
+// change and rewrite fc.json / null_fc.json after each quiet period.  Runs
+// until interrupted; returns non-zero only if the watch could not be set up.
+int run_watch(const Options &opt);
+
+#endif